@@ -0,0 +1,49 @@
+# ======================================================================
+# CGALib - Watcom C Version.
+# Host Makefile.
+#
+# Builds the library with gcc for the build machine, drawing to an
+# emulated screen in memory instead of CGA screen memory. Use GNU make:
+#
+#     make -f host.mak
+#
+# Released as Public Domain by Damian Gareth Walker, 2020.
+#
+
+# Directories
+SRCDIR = src
+INCDIR = inc
+OBJDIR = obj/host
+TGTDIR = cgalib
+
+# Tool commands and their options
+CC = gcc
+AR = ar
+COPTS = -O2 -W -Wall -fno-strict-aliasing -DCGA_HOST -I$(INCDIR)
+
+# Whole project
+all : \
+	$(TGTDIR)/libcga.a \
+	$(TGTDIR)/bit2ppm
+
+# Utilities
+$(TGTDIR)/bit2ppm : $(OBJDIR)/bit2ppm.o $(TGTDIR)/libcga.a
+	$(CC) -o $@ $^
+
+# Library
+$(TGTDIR)/libcga.a : \
+	$(OBJDIR)/screen.o \
+	$(OBJDIR)/bitmap.o \
+	$(OBJDIR)/font.o \
+	$(OBJDIR)/gif.o
+	$(AR) rcs $@ $^
+
+# Object files
+$(OBJDIR)/%.o : $(SRCDIR)/%.c $(INCDIR)/cgalib.h $(INCDIR)/screen.h \
+	$(INCDIR)/bitmap.h $(INCDIR)/font.h $(INCDIR)/gif.h
+	mkdir -p $(OBJDIR)
+	$(CC) $(COPTS) -c -o $@ $<
+
+# Remove the host build
+clean :
+	rm -rf $(OBJDIR) $(TGTDIR)/libcga.a $(TGTDIR)/bit2ppm
@@ -38,9 +38,32 @@ struct bitmap {
     /** @var pixels is a pointer to the pixel data */
     char *pixels;
 
+    /** @var view is 1 if the pixel data belongs to someone else */
+    int view;
+
+    /** @var shifted is the pixel data shifted right 1-3 pixels */
+    char *shifted[3];
+
 };
 #endif
 
+/*----------------------------------------------------------------------
+ * Internal Function Prototypes.
+ */
+
+#ifdef __CGALIB__
+/**
+ * Get the pixels of a bitmap shifted right, making them on first use.
+ * @param bitmap is the bitmap to shift.
+ * @param shift is the number of pixels to shift by, from 1 to 3.
+ * @param fill is the byte value to shift in at the edges.
+ * @returns the shifted pixels, one byte wider per row, or NULL.
+ * The shifted copy is made once and kept, so it will not reflect
+ * changes made to the bitmap after it was first drawn unaligned.
+ */
+char *bit_shifted (Bitmap *bitmap, int shift, int fill);
+#endif
+
 /*----------------------------------------------------------------------
  * Public Level Function Prototypes.
  */
@@ -67,6 +90,17 @@ Bitmap *bit_copy (Bitmap *src);
  */
 Bitmap *bit_read (FILE *input);
 
+/**
+ * Create a bitmap that uses pixel data already in memory.
+ * @param w is the width of the bitmap.
+ * @param h is the height of the bitmap.
+ * @param pixels is the pixel data, in the format bit_write () uses.
+ * @returns a new Bitmap.
+ * The pixel data is not copied, and is not freed by bit_destroy ();
+ * it must last as long as the bitmap does.
+ */
+Bitmap *bit_view (int w, int h, char *pixels);
+
 /**
  * Write a bitmap to an already-open file.
  * @param bitmap is the bitmap to write.
@@ -99,6 +133,26 @@ void bit_putpart (Bitmap *dst, Bitmap *src, int xd, int yd,
  */
 void bit_put (Bitmap *dst, Bitmap *src, int x, int y, DrawMode draw);
 
+/**
+ * Put a masked sprite onto a bitmap in a single pass.
+ * @param dst is the destination bitmap.
+ * @param src is the sprite bitmap.
+ * @param mask is the mask bitmap, the same size as the sprite.
+ * @param x is the x coordinate on the destination bitmap.
+ * @param y is the y coordinate on the destination bitmap.
+ */
+void bit_putmasked (Bitmap *dst, Bitmap *src, Bitmap *mask, int x, int y);
+
+/**
+ * Make the shifted copies of a masked sprite in advance.
+ * @param src is the sprite bitmap.
+ * @param mask is the mask bitmap, the same size as the sprite.
+ * @returns 1 if successful, 0 if there is not enough memory.
+ * Afterwards the sprite can be drawn at any x coordinate without
+ * any memory being allocated.
+ */
+int bit_preshift (Bitmap *src, Bitmap *mask);
+
 /**
  * Get one bitmap from another.
  * @param src is the source bitmap.
@@ -18,6 +18,7 @@
 typedef struct screen Screen;
 typedef struct bitmap Bitmap;
 typedef struct font Font;
+typedef struct gif Gif;
 
 /* Enum Type Definitions */
 typedef enum {
@@ -28,9 +29,18 @@ typedef enum {
     DRAW_XOR
 } DrawMode;
 
+/* host builds (CGA_HOST) have no segmented memory */
+#ifdef CGA_HOST
+#define far
+#define _fmemcpy memcpy
+#define _fmemset memset
+#define FP_OFF(p) ((unsigned int) (unsigned long) (p))
+#endif
+
 /* included headers */
 #include "screen.h"
 #include "bitmap.h"
 #include "font.h"
+#include "gif.h"
 
 #endif
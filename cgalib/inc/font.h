@@ -28,9 +28,32 @@ struct font {
 
     /** @var pixels is the pixel data for each character */
     char *pixels;
+
+    /** @var coloured is the pixel data in each ink and paper colour */
+    char *coloured[16];
+
+    /** @var view is 1 if the pixel data belongs to someone else */
+    int view;
 };
 #endif
 
+/*----------------------------------------------------------------------
+ * Internal Function Prototypes.
+ */
+
+#ifdef __CGALIB__
+/**
+ * Get the pixels of a font in given colours, making them on first use.
+ * @param font is the font to colour.
+ * @param ink is the ink colour.
+ * @param paper is the paper colour.
+ * @returns the coloured pixels, or NULL if there is not enough memory.
+ * The coloured copies are kept with the font until the font's pixels
+ * are changed by fnt_put() or fnt_colours().
+ */
+char *fnt_coloured (Font *font, int ink, int paper);
+#endif
+
 /*----------------------------------------------------------------------
  * Public Level Function Prototypes.
  */
@@ -57,6 +80,17 @@ Font *fnt_copy (Font *src);
  */
 Font *fnt_read (FILE *input);
 
+/**
+ * Create a font that uses pixel data already in memory.
+ * @param first is the first character in the font.
+ * @param last is the last character in the font.
+ * @param pixels is the pixel data, in the format fnt_write () uses.
+ * @returns the new font.
+ * The pixel data is not copied, and is not freed by fnt_destroy ();
+ * it must last as long as the font does.
+ */
+Font *fnt_view (int first, int last, char *pixels);
+
 /**
  * Write a font to an already open file.
  * @param font is the font to write.
@@ -85,16 +119,25 @@ void fnt_get (Font *src, Bitmap *dst, int ch);
  * @param font is the font to modify.
  * @param i is the ink colour.
  * @param p is the paper colour.
- * This function offers a quicker alternative to colouring text as it is
- * printed, and may be used if ALL text is going to be a certain colour.
- * It can be used in conjunction with the fnt_copy() function to quickly
- * output text in multiple colours (fnt_copy then apply fnt_colours).
- * Note that this assumes that the colours are already ink 3, paper 0.
- * After changing the font colours, this will no longer be the case
- * and further colour changes will have unpredictable results.
+ * Printing in other colours no longer needs this, as the print
+ * functions keep coloured copies of the font. Note that this assumes
+ * that the colours are already ink 3, paper 0. After changing the font
+ * colours, this will no longer be the case and further colour changes
+ * will have unpredictable results.
  */
 void fnt_colours (Font *font, int i, int p);
 
+/**
+ * Make a coloured copy of a font in advance.
+ * @param font is the font to colour.
+ * @param ink is the ink colour.
+ * @param paper is the paper colour.
+ * @returns 1 if successful, 0 if there is not enough memory.
+ * Afterwards printing in those colours needs no memory to be allocated,
+ * until the font is changed by fnt_put () or fnt_colours ().
+ */
+int fnt_precolour (Font *font, int ink, int paper);
+
 /**
  * Destroy a font.
  * @param font is the font to destroy.
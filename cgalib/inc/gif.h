@@ -0,0 +1,89 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * GIF Module Header.
+ *
+ * Definitions for the animated GIF functions. Also includes the GIF
+ * structure for internal use only.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ */
+
+#ifndef __GIF_H__
+#define __GIF_H__
+
+/*----------------------------------------------------------------------
+ * Internal Structures.
+ */
+
+/** @struct gif holds the state of an animated GIF being written */
+#ifdef __CGALIB__
+struct gif {
+
+    /** @var output is the output file handle */
+    FILE *output;
+
+    /** @var width is the width of the animation in pixels */
+    int width;
+
+    /** @var height is the height of the animation in pixels */
+    int height;
+
+    /** @var frames is the number of frames written so far */
+    int frames;
+
+    /** @var previous is the pixel data of the last frame written */
+    char *previous;
+
+    /** @var children is the LZW string table, as a tree */
+    unsigned int (*children)[4];
+
+    /** @var next is the next free LZW code */
+    int next;
+
+    /** @var bits is the current LZW code size in bits */
+    int bits;
+
+    /** @var buffer holds bits that are not yet a whole byte */
+    unsigned long buffer;
+
+    /** @var count is the number of bits in the buffer */
+    int count;
+
+    /** @var block is the data sub-block being filled */
+    unsigned char block[255];
+
+    /** @var size is the number of bytes in the data sub-block */
+    int size;
+};
+#endif
+
+/*----------------------------------------------------------------------
+ * Public Level Function Prototypes.
+ */
+
+/**
+ * Start an animated GIF, writing its header.
+ * @param screen is the screen whose palette the GIF will use.
+ * @param output is the output file handle.
+ * @param width is the width of the animation.
+ * @param height is the height of the animation.
+ * @returns a new Gif, or NULL if there is not enough memory.
+ */
+Gif *gif_create (Screen *screen, FILE *output, int width, int height);
+
+/**
+ * Add a frame to an animated GIF.
+ * @param gif is the GIF to add to.
+ * @param bitmap is the frame, the same size as the animation.
+ * @param delay is how long to show the frame, in 1/100 seconds.
+ * Only the area that has changed since the last frame is written.
+ */
+void gif_frame (Gif *gif, Bitmap *bitmap, int delay);
+
+/**
+ * Finish an animated GIF and destroy it.
+ * @param gif is the GIF to finish.
+ */
+void gif_destroy (Gif *gif);
+
+#endif
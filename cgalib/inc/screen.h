@@ -39,6 +39,19 @@ struct screen {
 };
 #endif
 
+/*----------------------------------------------------------------------
+ * Internal Function Prototypes.
+ */
+
+#ifdef __CGALIB__
+/**
+ * Work out the red, green and blue levels of the screen colours.
+ * @param screen is the screen.
+ * @param rgb is the array of levels to fill in for the four colours.
+ */
+void scr_rgb (Screen *screen, unsigned char rgb[4][3]);
+#endif
+
 /*----------------------------------------------------------------------
  * Public Level Function Prototypes.
  */
@@ -83,6 +96,16 @@ void scr_putpart (Screen *dst, Bitmap *src, int xd, int yd,
  */
 void scr_put (Screen *dst, Bitmap *src, int x, int y, DrawMode draw);
 
+/**
+ * Put a masked sprite onto the screen in a single pass.
+ * @param dst is the screen to affect.
+ * @param src is the sprite bitmap.
+ * @param mask is the mask bitmap, the same size as the sprite.
+ * @param x is the x coordinate at which the sprite is to be placed.
+ * @param y is the y coordinate at which the sprite is to be placed.
+ */
+void scr_putmasked (Screen *dst, Bitmap *src, Bitmap *mask, int x, int y);
+
 /**
  * Get a bitmap from the screen.
  * @param src is the screen from which the bitmap comes.
@@ -92,6 +115,13 @@ void scr_put (Screen *dst, Bitmap *src, int x, int y, DrawMode draw);
  */
 void scr_get (Screen *src, Bitmap *dst, int x, int y);
 
+/**
+ * Write the screen to an already open file as a PPM image.
+ * @param screen is the screen to write.
+ * @param output is the output file handle.
+ */
+void scr_dump (Screen *screen, FILE *output);
+
 /**
  * Draw a box on the screen, filled in the current ink colour.
  * @param screen is the screen to affect.
@@ -0,0 +1,64 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Bitmap preview utility.
+ * 
+ * Puts the bitmaps from a BIT file across the top of a screen and
+ * writes the screen to a PPM image. Intended for host builds, where
+ * the screen is emulated in memory.
+ * 
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 29-Jun-2020.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cgalib.h"
+
+int main (int argc, char **argv)
+{
+    Screen *screen;
+    FILE *fp;
+    char header[8];
+    int b;
+    Bitmap *bitmap;
+
+    /* check the parameters */
+    if (argc != 3) {
+        printf ("Usage: %s INFILE.BIT OUTFILE.PPM\n", argv[0]);
+        exit (0);
+    }
+
+    /* initialise the screen */
+    if (! (screen = scr_create (4))) {
+        printf ("Cannot initialise graphics mode!\n");
+        exit (1);
+    }
+
+    /* put the bitmaps on the screen */
+    if (! (fp = fopen (argv[1], "rb"))) {
+        printf ("Cannot load %s.\n", argv[1]);
+        exit (1);
+    }
+    if (! fread (header, 8, 1, fp) || strcmp (header, "CGA100B")) {
+        printf ("Cannot read header from %s.\n", argv[1]);
+        exit (1);
+    }
+    for (b = 0; b < 20 && (bitmap = bit_read (fp)); ++b) {
+        scr_put (screen, bitmap, 16 * b, 0, DRAW_PSET);
+        bit_destroy (bitmap);
+    }
+    fclose (fp);
+
+    /* write the screen to the image file */
+    if (! (fp = fopen (argv[2], "wb"))) {
+        printf ("Cannot create image file %s.\n", argv[2]);
+        exit (1);
+    }
+    scr_dump (screen, fp);
+    fclose (fp);
+
+    /* clean up at the end */
+    scr_destroy (screen);
+    return 0;
+}
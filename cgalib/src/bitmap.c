@@ -16,8 +16,131 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#ifndef CGA_HOST
+#include <dos.h>
+#endif
 #include "cgalib.h"
 
+/*----------------------------------------------------------------------
+ * Level 1 Functions.
+ */
+
+/**
+ * Put a row of bytes onto a bitmap row.
+ * @param d is the address to copy data to.
+ * @param s is the address to copy data from.
+ * @param bytes is the number of bytes to copy.
+ * @param draw is the drawing mode to use.
+ * Each draw mode has its own loop to keep the inner loop tight.
+ */
+static void put_row (char *d, char *s, int bytes, DrawMode draw)
+{
+    switch (draw) {
+        case DRAW_PSET:
+            _fmemcpy (d, s, bytes);
+            break;
+        case DRAW_PRESET:
+            while (bytes--)
+                *d++ = ~*s++;
+            break;
+        case DRAW_AND:
+            while (bytes--)
+                *d++ &= *s++;
+            break;
+        case DRAW_OR:
+            while (bytes--)
+                *d++ |= *s++;
+            break;
+        case DRAW_XOR:
+            while (bytes--)
+                *d++ ^= *s++;
+            break;
+    }
+}
+
+/**
+ * Put a masked row of bytes onto a bitmap row.
+ * @param d is the address to copy data to.
+ * @param s is the address of the sprite data.
+ * @param m is the address of the mask data.
+ * @param bytes is the number of bytes to copy.
+ * Rows starting on an even address are done a word at a time.
+ */
+static void put_masked_row (char *d, char *s, char *m, int bytes)
+{
+    /* local variables */
+    unsigned int *dw; /* word address to copy data to */
+    unsigned int *sw; /* word address of the sprite data */
+    unsigned int *mw; /* word address of the mask data */
+
+    /* copy whole words where the destination is aligned */
+    if (! (FP_OFF (d) & 1)) {
+        dw = (unsigned int *) d;
+        sw = (unsigned int *) s;
+        mw = (unsigned int *) m;
+        for (; bytes >= (int) sizeof (*dw); bytes -= sizeof (*dw), ++dw)
+            *dw = (*dw & *mw++) | *sw++;
+        d = (char *) dw;
+        s = (char *) sw;
+        m = (char *) mw;
+    }
+
+    /* copy any bytes that remain */
+    while (bytes--) {
+        *d = (*d & *m++) | *s++;
+        ++d;
+    }
+}
+
+/*----------------------------------------------------------------------
+ * Internal Level Functions.
+ */
+
+/**
+ * Get the pixels of a bitmap shifted right, making them on first use.
+ * @param bitmap is the bitmap to shift.
+ * @param shift is the number of pixels to shift by, from 1 to 3.
+ * @param fill is the byte value to shift in at the edges.
+ * @returns the shifted pixels, one byte wider per row, or NULL.
+ */
+char *bit_shifted (Bitmap *bitmap, int shift, int fill)
+{
+    /* local variables */
+    unsigned char *s; /* address to shift data from */
+    unsigned char *d; /* address to shift data to */
+    unsigned int prev; /* previous source byte */
+    unsigned int next; /* next source byte */
+    int bytes; /* bytes per row of the unshifted bitmap */
+    int r; /* row counter */
+    int b; /* byte counter */
+
+    /* return the shifted pixels if they have been made already */
+    if (bitmap->shifted[shift - 1])
+        return bitmap->shifted[shift - 1];
+
+    /* reserve memory for the shifted pixels */
+    bytes = bitmap->width / 4;
+    if (! (bitmap->shifted[shift - 1] = malloc ((bytes + 1)
+        * bitmap->height)))
+        return NULL;
+
+    /* shift each row, two bits per pixel */
+    s = (unsigned char *) bitmap->pixels;
+    d = (unsigned char *) bitmap->shifted[shift - 1];
+    for (r = 0; r < bitmap->height; ++r) {
+        prev = fill & 0xff;
+        for (b = 0; b <= bytes; ++b) {
+            next = (b < bytes) ? *s++ : (fill & 0xff);
+            *d++ = (unsigned char) ((prev << (8 - 2 * shift))
+                | (next >> (2 * shift)));
+            prev = next;
+        }
+    }
+
+    /* return the shifted pixels */
+    return bitmap->shifted[shift - 1];
+}
+
 /*----------------------------------------------------------------------
  * Public Level Functions.
  */
@@ -47,6 +170,8 @@ Bitmap *bit_create (int width, int height)
     bitmap->ink = 3;
     bitmap->paper = 0;
     bitmap->font = NULL;
+    bitmap->shifted[0] = bitmap->shifted[1] = bitmap->shifted[2] = NULL;
+    bitmap->view = 0;
 
     /* return the bitmap */
     return bitmap;
@@ -76,6 +201,8 @@ Bitmap *bit_copy (Bitmap *src)
     dst->ink = src->ink;
     dst->paper = src->paper;
     dst->font = src->font;
+    dst->shifted[0] = dst->shifted[1] = dst->shifted[2] = NULL;
+    dst->view = 0;
     memcpy (dst->pixels, src->pixels, src->width / 4 * src->height);
 
     /* return the bitmap */
@@ -92,8 +219,8 @@ Bitmap *bit_read (FILE *input)
 {
     /* local variables */
     Bitmap *bitmap; /* the bitmap to return */
-    int w; /* the width read from a file */
-    int h; /* the height read from a file */
+    int w = 0; /* the width read from a file */
+    int h = 0; /* the height read from a file */
 
     /* attempt to read the width and height */
     if (! fread (&w, 2, 1, input))
@@ -122,6 +249,38 @@ Bitmap *bit_read (FILE *input)
     bitmap->ink = 3;
     bitmap->paper = 0;
     bitmap->font = NULL;
+    bitmap->shifted[0] = bitmap->shifted[1] = bitmap->shifted[2] = NULL;
+    bitmap->view = 0;
+
+    /* return the bitmap */
+    return bitmap;
+}
+
+/**
+ * Create a bitmap that uses pixel data already in memory.
+ * @param w is the width of the bitmap.
+ * @param h is the height of the bitmap.
+ * @param pixels is the pixel data, in the format bit_write () uses.
+ * @returns a new Bitmap.
+ */
+Bitmap *bit_view (int w, int h, char *pixels)
+{
+    /* local variables */
+    Bitmap *bitmap; /* the bitmap to return */
+
+    /* reserve memory for the bitmap only */
+    if (! (bitmap = malloc (sizeof (Bitmap))))
+        return NULL;
+
+    /* initialise the data */
+    bitmap->width = w;
+    bitmap->height = h;
+    bitmap->ink = 3;
+    bitmap->paper = 0;
+    bitmap->font = NULL;
+    bitmap->pixels = pixels;
+    bitmap->shifted[0] = bitmap->shifted[1] = bitmap->shifted[2] = NULL;
+    bitmap->view = 1;
 
     /* return the bitmap */
     return bitmap;
@@ -162,40 +321,13 @@ void bit_putpart (Bitmap *dst, Bitmap *src, int xd, int yd,
     char *d; /* address to copy data to */
     char *s; /* address to copy data from */
     int r; /* row counter */
-    int b; /* byte counter */
 
     /* copy the pixels */
-    for (r = 0; r < h; ++r)
-
-        /* DRAW_PSET can be copied by a quicker method */
-        if (draw == DRAW_PSET) {
-            d = dst->pixels + xd / 4 + (yd + r) * (dst->width / 4);
-            s = src->pixels + (xs / 4) + (src->width / 4) * (ys + r);
-            _fmemcpy (d, s, w / 4);
-        }
-        
-        /* the other draw operations need doing byte by byte */
-        else 
-            for (b = 0; b < w / 4; ++b) {
-                d = dst->pixels + b + xd / 4
-                    + (yd + r) * (dst->width / 4);
-                s = b + src->pixels + (xs / 4)
-		    + (src->width) / 4 * (ys + r);
-                switch (draw) {
-                    case DRAW_PRESET:
-                        *d = ~*s;
-                        break;
-                    case DRAW_AND:
-                        *d &= *s;
-                        break;
-                    case DRAW_OR:
-                        *d |= *s;
-                        break;
-                    case DRAW_XOR:
-                        *d ^= *s;
-                        break;
-                }
-            }
+    for (r = 0; r < h; ++r) {
+        d = dst->pixels + xd / 4 + (yd + r) * (dst->width / 4);
+        s = src->pixels + (xs / 4) + (src->width / 4) * (ys + r);
+        put_row (d, s, w / 4, draw);
+    }
 }
 
 /**
@@ -212,39 +344,69 @@ void bit_put (Bitmap *dst, Bitmap *src, int x, int y, DrawMode draw)
     char *d; /* address to copy data to */
     char *s; /* address to copy data from */
     int r; /* row counter */
-    int b; /* byte counter */
 
     /* copy the pixels */
-    for (r = 0; r < src->height; ++r)
+    for (r = 0; r < src->height; ++r) {
+        d = dst->pixels + x / 4 + (y + r) * (dst->width / 4);
+        s = src->pixels + src->width / 4 * r;
+        put_row (d, s, src->width / 4, draw);
+    }
+}
 
-        /* DRAW_PSET can be copied by a quicker method */
-        if (draw == DRAW_PSET) {
-            d = dst->pixels + x / 4 + (y + r) * (dst->width / 4);
-            s = src->pixels + src->width / 4 * r;
-            _fmemcpy (d, s, src->width / 4);
-        }
-        
-        /* the other draw operations need doing byte by byte */
-        else 
-            for (b = 0; b < src->width / 4; ++b) {
-                d = dst->pixels + b + x / 4
-                    + (y + r) * (dst->width / 4);
-                s = b + src->pixels + src->width / 4 * r;
-                switch (draw) {
-                    case DRAW_PRESET:
-                        *d = ~*s;
-                        break;
-                    case DRAW_AND:
-                        *d &= *s;
-                        break;
-                    case DRAW_OR:
-                        *d |= *s;
-                        break;
-                    case DRAW_XOR:
-                        *d ^= *s;
-                        break;
-                }
-            }
+/**
+ * Put a masked sprite onto a bitmap in a single pass.
+ * @param dst is the destination bitmap.
+ * @param src is the sprite bitmap.
+ * @param mask is the mask bitmap, the same size as the sprite.
+ * @param x is the x coordinate on the destination bitmap.
+ * @param y is the y coordinate on the destination bitmap.
+ * This has the same effect as putting the mask with DRAW_AND and then
+ * the sprite with DRAW_OR, but x need not be a multiple of 4.
+ */
+void bit_putmasked (Bitmap *dst, Bitmap *src, Bitmap *mask, int x, int y)
+{
+    /* local variables */
+    char *d; /* address to copy data to */
+    char *s; /* sprite pixels to copy */
+    char *m; /* mask pixels to copy */
+    int r; /* row counter */
+    int bytes; /* bytes per row of the sprite */
+
+    /* unaligned sprites use shifted copies that are a byte wider */
+    bytes = src->width / 4;
+    if (x % 4 &&
+        (s = bit_shifted (src, x % 4, 0x00)) &&
+        (m = bit_shifted (mask, x % 4, 0xff)))
+        ++bytes;
+    else {
+        s = src->pixels;
+        m = mask->pixels;
+    }
+
+    /* copy the pixels */
+    for (r = 0; r < src->height; ++r) {
+        d = dst->pixels + x / 4 + (y + r) * (dst->width / 4);
+        put_masked_row (d, s + bytes * r, m + bytes * r, bytes);
+    }
+}
+
+/**
+ * Make the shifted copies of a masked sprite in advance.
+ * @param src is the sprite bitmap.
+ * @param mask is the mask bitmap, the same size as the sprite.
+ * @returns 1 if successful, 0 if there is not enough memory.
+ */
+int bit_preshift (Bitmap *src, Bitmap *mask)
+{
+    /* local variables */
+    int shift; /* shift counter */
+
+    /* make the copies for each unaligned position */
+    for (shift = 1; shift < 4; ++shift)
+        if (! bit_shifted (src, shift, 0x00) ||
+            ! bit_shifted (mask, shift, 0xff))
+            return 0;
+    return 1;
 }
 
 /**
@@ -309,24 +471,27 @@ void bit_print (Bitmap *bitmap, int x, int y, char *message)
     /* local variables */
     int b; /* character pointer */
     int r; /* row of character */
-    char v; /* value of byte in character */
+    char *glyphs; /* the font's pixels in the current colours */
+    char *s; /* pointer to the character's pixels */
     char *d; /* pointer to destination byte on screen */
 
     /* only try to print if a font is selected */
     if (! bitmap->font) return;
 
+    /* use the font in the current colours, or as it is if need be */
+    if (! (glyphs = fnt_coloured (bitmap->font, bitmap->ink,
+        bitmap->paper)))
+        glyphs = bitmap->font->pixels;
+
     /* print each character */
-    for (b = 0; message[b]; ++b)
+    for (b = 0; message[b]; ++b) {
+        s = glyphs + 8 * (message[b] - bitmap->font->first);
+        d = bitmap->pixels + b + x / 4 + y * (bitmap->width / 4);
         for (r = 0; r < 8; ++r) {
-            d = bitmap->pixels + b + x / 4 +
-                (y + r) * (bitmap->width / 4);
-            v = bitmap->font->pixels[r + 8
-                * (message[b] - bitmap->font->first)];
-            if (bitmap->ink != 3 || bitmap->paper != 0)
-                v = (v & 0x55 * bitmap->ink)
-                    | ((0xff ^ v) & 0x55 * bitmap->paper);
-            *d = v;
+            *d = s[r];
+            d += bitmap->width / 4;
         }
+    }
 }
 
 /**
@@ -365,9 +530,16 @@ void bit_font (Bitmap *bitmap, Font *font)
  */
 void bit_destroy (Bitmap *bitmap)
 {
+    /* local variables */
+    int s; /* shift counter */
+
+    /* free the bitmap and any shifted copies of its pixels */
     if (bitmap) {
-        if (bitmap->pixels)
+        if (bitmap->pixels && ! bitmap->view)
             free (bitmap->pixels);
+        for (s = 0; s < 3; ++s)
+            if (bitmap->shifted[s])
+                free (bitmap->shifted[s]);
         free (bitmap);
     }
 }
@@ -15,6 +15,71 @@
 #include <string.h>
 #include "cgalib.h"
 
+/*----------------------------------------------------------------------
+ * Level 1 Functions.
+ */
+
+/**
+ * Discard the coloured copies of a font's pixels.
+ * @param font is the font.
+ */
+static void clear_coloured (Font *font)
+{
+    /* local variables */
+    int c; /* colour combination counter */
+
+    /* free the copies that have been made */
+    for (c = 0; c < 16; ++c)
+        if (font->coloured[c]) {
+            free (font->coloured[c]);
+            font->coloured[c] = NULL;
+        }
+}
+
+/*----------------------------------------------------------------------
+ * Internal Level Functions.
+ */
+
+/**
+ * Get the pixels of a font in given colours, making them on first use.
+ * @param font is the font to colour.
+ * @param ink is the ink colour.
+ * @param paper is the paper colour.
+ * @returns the coloured pixels, or NULL if there is not enough memory.
+ */
+char *fnt_coloured (Font *font, int ink, int paper)
+{
+    /* local variables */
+    char *coloured; /* the coloured pixels */
+    int size; /* the size of the pixel data */
+    int b; /* byte counter */
+    char i; /* ink mask */
+    char p; /* paper mask */
+
+    /* the font's own pixels are ink 3 on paper 0 */
+    if (ink == 3 && paper == 0)
+        return font->pixels;
+
+    /* return the coloured pixels if they have been made already */
+    if (font->coloured[4 * ink + paper])
+        return font->coloured[4 * ink + paper];
+
+    /* reserve memory for the coloured pixels */
+    size = 8 * (font->last - font->first + 1);
+    if (! (coloured = malloc (size)))
+        return NULL;
+
+    /* recolour each byte, four pixels at a time */
+    i = ink * 0x55;
+    p = paper * 0x55;
+    for (b = 0; b < size; ++b)
+        coloured[b] = (font->pixels[b] & i) | ((0xff ^ font->pixels[b]) & p);
+
+    /* keep and return the coloured pixels */
+    font->coloured[4 * ink + paper] = coloured;
+    return coloured;
+}
+
 /*----------------------------------------------------------------------
  * Public Level Functions.
  */
@@ -41,6 +106,8 @@ Font *fnt_create (int first, int last)
     /* set the font information */
     font->first = first;
     font->last = last;
+    memset (font->coloured, 0, sizeof (font->coloured));
+    font->view = 0;
 
     /* return the font */
     return font;
@@ -67,6 +134,8 @@ Font *fnt_copy (Font *src)
     /* set the font information */
     dst->first = src->first;
     dst->last = src->last;
+    memset (dst->coloured, 0, sizeof (dst->coloured));
+    dst->view = 0;
     memcpy (dst->pixels, src->pixels, 8 * (src->last - src->first + 1));
 
     /* return the font */
@@ -109,6 +178,35 @@ Font *fnt_read (FILE *input)
     /* set the other font information */
     font->first = f;
     font->last = l;
+    memset (font->coloured, 0, sizeof (font->coloured));
+    font->view = 0;
+
+    /* return the font */
+    return font;
+}
+
+/**
+ * Create a font that uses pixel data already in memory.
+ * @param first is the first character in the font.
+ * @param last is the last character in the font.
+ * @param pixels is the pixel data, in the format fnt_write () uses.
+ * @returns the new font.
+ */
+Font *fnt_view (int first, int last, char *pixels)
+{
+    /* local variables */
+    Font *font; /* the font to return */
+
+    /* attempt to reserve memory for the font only */
+    if (! (font = malloc (sizeof (Font))))
+        return NULL;
+
+    /* set the font information */
+    font->first = first;
+    font->last = last;
+    font->pixels = pixels;
+    memset (font->coloured, 0, sizeof (font->coloured));
+    font->view = 1;
 
     /* return the font */
     return font;
@@ -139,6 +237,7 @@ void fnt_write (Font *font, FILE *output)
 void fnt_put (Font *dst, Bitmap *src, int ch)
 {
     memcpy (dst->pixels + 8 * (ch - dst->first), src->pixels, 8);
+    clear_coloured (dst);
 }
 
 /**
@@ -157,13 +256,11 @@ void fnt_get (Font *src, Bitmap *dst, int ch)
  * @param font is the font to modify.
  * @param ink is the ink colour.
  * @param paper is the paper colour.
- * This function offers a quicker alternative to colouring text as it is
- * printed, and may be used if ALL text is going to be a certain colour.
- * It can be used in conjunction with the fnt_copy() function to quickly
- * output text in multiple colours (fnt_copy then apply fnt_colours).
- * Note that this assumes that the colours are already ink 3, paper 0.
- * After changing the font colours, this will no longer be the case
- * and further colour changes will have unpredictable results.
+ * Printing in other colours no longer needs this, as the print
+ * functions keep coloured copies of the font. Note that this assumes
+ * that the colours are already ink 3, paper 0. After changing the font
+ * colours, this will no longer be the case and further colour changes
+ * will have unpredictable results.
  */
 void fnt_colours (Font *font, int ink, int paper)
 {
@@ -186,6 +283,19 @@ void fnt_colours (Font *font, int ink, int paper)
             b = (0xff ^ font->pixels[8 * ch + r]) & p;
             font->pixels[8 * ch + r] = f | b;
         }
+    clear_coloured (font);
+}
+
+/**
+ * Make a coloured copy of a font in advance.
+ * @param font is the font to colour.
+ * @param ink is the ink colour.
+ * @param paper is the paper colour.
+ * @returns 1 if successful, 0 if there is not enough memory.
+ */
+int fnt_precolour (Font *font, int ink, int paper)
+{
+    return fnt_coloured (font, ink, paper) != NULL;
 }
 
 /**
@@ -195,7 +305,8 @@ void fnt_colours (Font *font, int ink, int paper)
 void fnt_destroy (Font *font)
 {
     if (font) {
-        if (font->pixels)
+        clear_coloured (font);
+        if (font->pixels && ! font->view)
             free (font->pixels);
         free (font);
     }
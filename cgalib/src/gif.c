@@ -0,0 +1,299 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * GIF Module.
+ *
+ * Writes bitmaps as the frames of an animated GIF, one frame at a
+ * time, so that an animation of any length can be recorded.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ */
+
+/* default CGALIB macro for access to internal structures */
+#define __CGALIB__
+
+/* included headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cgalib.h"
+
+/*----------------------------------------------------------------------
+ * Constants.
+ */
+
+/** @const CLEAR is the LZW clear code for a four colour image */
+#define CLEAR 4
+
+/** @const END is the LZW end of information code */
+#define END 5
+
+/** @const MAXCODE is the highest LZW code a GIF allows */
+#define MAXCODE 4095
+
+/*----------------------------------------------------------------------
+ * Level 2 Functions.
+ */
+
+/**
+ * Write out the data sub-block if it is not empty.
+ * @param gif is the GIF being written.
+ */
+static void flush_block (Gif *gif)
+{
+    if (gif->size) {
+        fputc (gif->size, gif->output);
+        fwrite (gif->block, gif->size, 1, gif->output);
+        gif->size = 0;
+    }
+}
+
+/**
+ * Clear the LZW string table.
+ * @param gif is the GIF being written.
+ */
+static void clear_table (Gif *gif)
+{
+    memset (gif->children, 0, (MAXCODE + 1) * sizeof (*gif->children));
+    gif->next = END + 1;
+    gif->bits = 3;
+}
+
+/*----------------------------------------------------------------------
+ * Level 1 Functions.
+ */
+
+/**
+ * Write an LZW code, a byte at a time as the bits build up.
+ * @param gif is the GIF being written.
+ * @param code is the code to write.
+ */
+static void put_code (Gif *gif, int code)
+{
+    /* add the code to the bit buffer, lowest bits first */
+    gif->buffer |= (unsigned long) code << gif->count;
+    gif->count += gif->bits;
+
+    /* move whole bytes into the data sub-block */
+    while (gif->count >= 8) {
+        gif->block[gif->size++] = (unsigned char) (gif->buffer & 0xff);
+        gif->buffer >>= 8;
+        gif->count -= 8;
+        if (gif->size == 255)
+            flush_block (gif);
+    }
+
+    /* the code size grows once the table needs the extra bit */
+    if (gif->next > (1 << gif->bits) - 1 && gif->bits < 12)
+        ++gif->bits;
+}
+
+/**
+ * Write a rectangle of a bitmap as LZW compressed image data.
+ * @param gif is the GIF being written.
+ * @param bitmap is the bitmap.
+ * @param x is the x coordinate of the rectangle, divisible by 4.
+ * @param y is the y coordinate of the rectangle.
+ * @param w is the width of the rectangle, divisible by 4.
+ * @param h is the height of the rectangle.
+ */
+static void put_pixels (Gif *gif, Bitmap *bitmap, int x, int y, int w,
+    int h)
+{
+    /* local variables */
+    unsigned char *s; /* address of the row being compressed */
+    int prefix = -1; /* the code for the string matched so far */
+    int pixel; /* the current pixel colour */
+    int r; /* row counter */
+    int c; /* column counter */
+
+    /* start the image data */
+    fputc (2, gif->output);
+    gif->buffer = 0;
+    gif->count = 0;
+    gif->size = 0;
+    clear_table (gif);
+    put_code (gif, CLEAR);
+
+    /* compress the pixels, extending the matched string if we can */
+    for (r = y; r < y + h; ++r) {
+        s = (unsigned char *) bitmap->pixels + (bitmap->width / 4) * r;
+        for (c = x; c < x + w; ++c) {
+            pixel = (s[c / 4] >> (6 - 2 * (c % 4))) & 3;
+            if (prefix == -1)
+                prefix = pixel;
+            else if (gif->children[prefix][pixel])
+                prefix = gif->children[prefix][pixel];
+            else {
+                put_code (gif, prefix);
+                if (gif->next > MAXCODE) {
+                    put_code (gif, CLEAR);
+                    clear_table (gif);
+                } else
+                    gif->children[prefix][pixel] = gif->next++;
+                prefix = pixel;
+            }
+        }
+    }
+
+    /* finish the image data */
+    put_code (gif, prefix);
+    put_code (gif, END);
+    if (gif->count)
+        gif->block[gif->size++] = (unsigned char) (gif->buffer & 0xff);
+    flush_block (gif);
+    fputc (0, gif->output);
+}
+
+/**
+ * Write a 16-bit number in the GIF's byte order.
+ * @param gif is the GIF being written.
+ * @param value is the number to write.
+ */
+static void put_word (Gif *gif, int value)
+{
+    fputc (value & 0xff, gif->output);
+    fputc ((value >> 8) & 0xff, gif->output);
+}
+
+/*----------------------------------------------------------------------
+ * Public Level Functions.
+ */
+
+/**
+ * Start an animated GIF, writing its header.
+ * @param screen is the screen whose palette the GIF will use.
+ * @param output is the output file handle.
+ * @param width is the width of the animation.
+ * @param height is the height of the animation.
+ * @returns a new Gif, or NULL if there is not enough memory.
+ */
+Gif *gif_create (Screen *screen, FILE *output, int width, int height)
+{
+    /* local variables */
+    Gif *gif; /* the new GIF */
+    unsigned char rgb[4][3]; /* the colour table */
+
+    /* reserve memory */
+    if (! (gif = malloc (sizeof (Gif))))
+        return NULL;
+    if (! (gif->previous = malloc (width / 4 * height))) {
+        free (gif);
+        return NULL;
+    }
+    if (! (gif->children = malloc ((MAXCODE + 1)
+        * sizeof (*gif->children)))) {
+        free (gif->previous);
+        free (gif);
+        return NULL;
+    }
+
+    /* initialise the data */
+    gif->output = output;
+    gif->width = width;
+    gif->height = height;
+    gif->frames = 0;
+
+    /* write the header and the screen's colours */
+    scr_rgb (screen, rgb);
+    fwrite ("GIF89a", 6, 1, output);
+    put_word (gif, width);
+    put_word (gif, height);
+    fputc (0x91, output); /* 4 colour table, 2 bits per primary */
+    fputc (0, output); /* background colour */
+    fputc (0, output); /* square pixels */
+    fwrite (rgb, 12, 1, output);
+
+    /* ask for the animation to loop */
+    fwrite ("\x21\xff\x0bNETSCAPE2.0\x03\x01", 16, 1, output);
+    put_word (gif, 0);
+    fputc (0, output);
+
+    /* return the GIF */
+    return gif;
+}
+
+/**
+ * Add a frame to an animated GIF.
+ * @param gif is the GIF to add to.
+ * @param bitmap is the frame, the same size as the animation.
+ * @param delay is how long to show the frame, in 1/100 seconds.
+ */
+void gif_frame (Gif *gif, Bitmap *bitmap, int delay)
+{
+    /* local variables */
+    char *s; /* address of a row of the frame */
+    char *p; /* address of a row of the previous frame */
+    int bytes; /* bytes per row */
+    int top; /* first changed row */
+    int bottom; /* row after the last changed row */
+    int left; /* first changed byte in a row */
+    int right; /* byte after the last changed byte in a row */
+    int r; /* row counter */
+    int b; /* byte counter */
+
+    /* find the rectangle that has changed since the last frame */
+    bytes = gif->width / 4;
+    if (gif->frames) {
+        top = gif->height;
+        bottom = 0;
+        left = bytes;
+        right = 0;
+        for (r = 0; r < gif->height; ++r) {
+            s = bitmap->pixels + bytes * r;
+            p = gif->previous + bytes * r;
+            if (! memcmp (s, p, bytes))
+                continue;
+            if (r < top)
+                top = r;
+            bottom = r + 1;
+            for (b = 0; b < left && s[b] == p[b]; ++b);
+            left = b;
+            for (b = bytes; b > right && s[b - 1] == p[b - 1]; --b);
+            right = b;
+        }
+    } else {
+        top = left = 0;
+        bottom = gif->height;
+        right = bytes;
+    }
+
+    /* an unchanged frame still needs a pixel to carry its delay */
+    if (top >= bottom) {
+        top = left = 0;
+        bottom = right = 1;
+    }
+
+    /* write the delay, keeping earlier frames underneath this one */
+    fwrite ("\x21\xf9\x04\x04", 4, 1, gif->output);
+    put_word (gif, delay);
+    fputc (0, gif->output);
+    fputc (0, gif->output);
+
+    /* write the image descriptor and the changed pixels */
+    fputc (0x2c, gif->output);
+    put_word (gif, 4 * left);
+    put_word (gif, top);
+    put_word (gif, 4 * (right - left));
+    put_word (gif, bottom - top);
+    fputc (0, gif->output);
+    put_pixels (gif, bitmap, 4 * left, top, 4 * (right - left),
+        bottom - top);
+
+    /* remember the frame for comparison with the next one */
+    memcpy (gif->previous, bitmap->pixels, bytes * gif->height);
+    ++gif->frames;
+}
+
+/**
+ * Finish an animated GIF and destroy it.
+ * @param gif is the GIF to finish.
+ */
+void gif_destroy (Gif *gif)
+{
+    if (gif) {
+        fputc (0x3b, gif->output);
+        free (gif->children);
+        free (gif->previous);
+        free (gif);
+    }
+}
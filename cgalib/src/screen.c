@@ -11,15 +11,62 @@
 
 /* headers required for references to data types */
 #include <stdlib.h>
+#ifndef CGA_HOST
 #include <conio.h>
 #include <dos.h>
+#endif
 #include <string.h>
 #include "cgalib.h"
 
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+#ifdef CGA_HOST
+/** @var framebuffer is the emulated screen memory on a host build */
+static char framebuffer[0x4000];
+#define SCREEN_EVEN ((char far *) framebuffer)
+#define SCREEN_ODD ((char far *) framebuffer + 0x2000)
+#else
+#define SCREEN_EVEN ((char far *) 0xb8000000)
+#define SCREEN_ODD ((char far *) 0xb8002000)
+#endif
+
+/** @var background is the EGA colour for each background colour */
+static int background[16] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0x3e, 0x3f
+};
+
+/** @var foreground is the EGA colour for each palette's colours */
+static int foreground[6][3] = {
+    {0x02, 0x04, 0x06}, /* mode 4 palette 0 bright 0 */
+    {0x03, 0x05, 0x07}, /* mode 4 palette 1 bright 0 */
+    {0x03, 0x04, 0x07}, /* mode 5 palette 2 bright 0 */
+    {0x3a, 0x3c, 0x3e}, /* mode 4 palette 0 bright 1 */
+    {0x3b, 0x3d, 0x3f}, /* mode 4 palette 1 bright 1 */
+    {0x3b, 0x3c, 0x3f}, /* mode 5 palette 2 bright 1 */
+};
+
 /*----------------------------------------------------------------------
  * Level 1 Functions.
  */
 
+#ifdef CGA_HOST
+
+/**
+ * Set the display mode.
+ * @params mode is the mode to select.
+ * A host build just clears the emulated screen, as the BIOS would.
+ */
+static void set_mode (Screen *screen)
+{
+    screen = screen; /* shut the compiler up, hopefully */
+    memset (framebuffer, 0, sizeof (framebuffer));
+}
+
+#else
+
 /**
  * Set the display mode.
  * @params mode is the mode to select.
@@ -35,6 +82,8 @@ static void set_mode (Screen *screen)
     int86 (0x10, &regs, &regs);
 }
 
+#endif
+
 /**
  * Sets the desired screen colours using the CGA palette register.
  * This works only on actual CGA cards. These palette registers are
@@ -68,8 +117,10 @@ static void palette_cga (Screen *screen)
     colour_control |= screen->colour; /* colour choice */
 
     /* set the CGA registers */
+#ifndef CGA_HOST
     outp (0x3d8, mode_control);
     outp (0x3d9, colour_control);
+#endif
 }
 
 /**
@@ -82,19 +133,8 @@ static void palette_cga (Screen *screen)
  */
 static void palette_ega (Screen *screen)
 {
+#ifndef CGA_HOST
     union REGS regs;
-    static int background[16] = { /* background colours */
-        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
-        0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0x3e, 0x3f
-    };
-    static int foreground[6][3] = { /* table of 320x200 mode colours */
-        {0x02, 0x04, 0x06}, /* mode 4 palette 0 bright 0 */
-        {0x03, 0x05, 0x07}, /* mode 4 palette 1 bright 0 */
-        {0x03, 0x04, 0x07}, /* mode 5 palette 2 bright 0 */
-        {0x3a, 0x3c, 0x3e}, /* mode 4 palette 0 bright 1 */
-        {0x3b, 0x3d, 0x3f}, /* mode 4 palette 1 bright 1 */
-        {0x3b, 0x3c, 0x3f}, /* mode 5 palette 2 bright 1 */
-    };
     int fgcount; /* count of foreground colours */
 
     /* don't do any of this if we're in monochrome mode */
@@ -112,6 +152,128 @@ static void palette_ega (Screen *screen)
             + fgcount + 1;
         int86 (0x10, &regs, &regs);
     }
+#else
+    screen = screen; /* a host build has no palette registers */
+#endif
+}
+
+/**
+ * Work out the red, green and blue levels of an EGA colour.
+ * @param ega is the EGA colour, in rgbRGB format.
+ * @param rgb is the array of three levels to fill in.
+ */
+static void ega_rgb (int ega, unsigned char *rgb)
+{
+    rgb[0] = 0xaa * ((ega >> 2) & 1) + 0x55 * ((ega >> 5) & 1);
+    rgb[1] = 0xaa * ((ega >> 1) & 1) + 0x55 * ((ega >> 4) & 1);
+    rgb[2] = 0xaa * (ega & 1) + 0x55 * ((ega >> 3) & 1);
+}
+
+/**
+ * Work out the screen address of a pixel row.
+ * @param x is the x coordinate of the start of the row.
+ * @param y is the y coordinate of the row.
+ * @returns the address of the byte containing the pixel.
+ * Odd rows are in the second bank of the interlaced screen memory.
+ */
+static char far *row_address (int x, int y)
+{
+    return (y % 2)
+        ? x / 4 + (y / 2) * 80 + SCREEN_ODD
+        : x / 4 + (y / 2) * 80 + SCREEN_EVEN;
+}
+
+/**
+ * Put a row of bytes onto a screen row.
+ * @param d is the screen address to copy data to.
+ * @param s is the address to copy data from.
+ * @param bytes is the number of bytes to copy.
+ * @param draw is the drawing mode to use.
+ * Each draw mode has its own loop to keep the inner loop tight.
+ */
+static void put_row (char far *d, char *s, int bytes, DrawMode draw)
+{
+    switch (draw) {
+        case DRAW_PSET:
+            _fmemcpy (d, s, bytes);
+            break;
+        case DRAW_PRESET:
+            while (bytes--)
+                *d++ = ~*s++;
+            break;
+        case DRAW_AND:
+            while (bytes--)
+                *d++ &= *s++;
+            break;
+        case DRAW_OR:
+            while (bytes--)
+                *d++ |= *s++;
+            break;
+        case DRAW_XOR:
+            while (bytes--)
+                *d++ ^= *s++;
+            break;
+    }
+}
+
+/**
+ * Put a masked row of bytes onto a screen row.
+ * @param d is the screen address to copy data to.
+ * @param s is the address of the sprite data.
+ * @param m is the address of the mask data.
+ * @param bytes is the number of bytes to copy.
+ * Rows starting on an even address are done a word at a time.
+ */
+static void put_masked_row (char far *d, char *s, char *m, int bytes)
+{
+    /* local variables */
+    unsigned int far *dw; /* word address to copy data to */
+    unsigned int *sw; /* word address of the sprite data */
+    unsigned int *mw; /* word address of the mask data */
+
+    /* copy whole words where the destination is aligned */
+    if (! (FP_OFF (d) & 1)) {
+        dw = (unsigned int far *) d;
+        sw = (unsigned int *) s;
+        mw = (unsigned int *) m;
+        for (; bytes >= (int) sizeof (*dw); bytes -= sizeof (*dw), ++dw)
+            *dw = (*dw & *mw++) | *sw++;
+        d = (char far *) dw;
+        s = (char *) sw;
+        m = (char *) mw;
+    }
+
+    /* copy any bytes that remain */
+    while (bytes--) {
+        *d = (*d & *m++) | *s++;
+        ++d;
+    }
+}
+
+/*----------------------------------------------------------------------
+ * Internal Level Functions.
+ */
+
+/**
+ * Work out the red, green and blue levels of the screen colours.
+ * @param screen is the screen.
+ * @param rgb is the array of levels to fill in for the four colours.
+ * In mode 6 the colours are shades of grey, as dithering shows them.
+ */
+void scr_rgb (Screen *screen, unsigned char rgb[4][3])
+{
+    /* local variables */
+    int c; /* colour counter */
+
+    /* work out the levels for each colour */
+    if (screen->mode == 6)
+        for (c = 0; c < 4; ++c)
+            rgb[c][0] = rgb[c][1] = rgb[c][2] = 0x55 * c;
+    else {
+        ega_rgb (background[screen->colour], rgb[0]);
+        for (c = 0; c < 3; ++c)
+            ega_rgb (foreground[screen->palette][c], rgb[c + 1]);
+    }
 }
 
 /*----------------------------------------------------------------------
@@ -183,49 +345,16 @@ void scr_putpart (Screen *dst, Bitmap *src, int xd, int yd,
     char far *d; /* address to copy data to */
     char *s; /* address to copy data from */
     int r; /* row counter */
-    int b; /* byte counter */
 
     /* dst is not used but here for future proofing */
     dst = dst; /* shut the compiler up, hopefully */
 
     /* copy the pixels */
-    for (r = 0; r < h; ++r)
-
-        /* DRAW_PSET can be copied by a quicker method */
-        if (draw == DRAW_PSET) {
-            d = (r % 2)
-                ? xd / 4 + (yd + r - 1) * 40 + (char far *) 0xb8002000
-                : xd / 4 + (yd + r) * 40 + (char far *) 0xb8000000;
-            s = src->pixels + (xs / 4) + (src->width / 4) * (ys + r);
-            _fmemcpy (d, s, w / 4);
-        }
-        
-	/* the other draw operations need doing byte by byte */
-        else 
-            for (b = 0; b < w / 4; ++b) {
-                d = b +
-		    ((r % 2)
-		     ? xd / 4 + (yd + r - 1) * 40
-		     + (char far *) 0xb8002000
-		     : xd / 4 + (yd + r) * 40
-		     + (char far *) 0xb8000000);
-                s = b + src->pixels + (xs / 4)
-		    + (src->width / 4) * (ys + r);
-                switch (draw) {
-		case DRAW_PRESET:
-		    *d = ~*s;
-		    break;
-		case DRAW_AND:
-		    *d &= *s;
-		    break;
-		case DRAW_OR:
-		    *d |= *s;
-		    break;
-		case DRAW_XOR:
-		    *d ^= *s;
-		    break;
-                }
-            }
+    for (r = 0; r < h; ++r) {
+        d = row_address (xd, yd + r);
+        s = src->pixels + (xs / 4) + (src->width / 4) * (ys + r);
+        put_row (d, s, w / 4, draw);
+    }
 }
 
 /**
@@ -242,45 +371,56 @@ void scr_put (Screen *dst, Bitmap *src, int x, int y, DrawMode draw)
     char far *d; /* address to copy data to */
     char *s; /* address to copy data from */
     int r; /* row counter */
-    int b; /* byte counter */
 
     /* dst is not used but here for future proofing */
     dst = dst; /* shut the compiler up, hopefully */
 
     /* copy the pixels */
-    for (r = 0; r < src->height; ++r)
-
-        /* DRAW_PSET can be copied by a quicker method */
-        if (draw == DRAW_PSET) {
-            d = (r % 2)
-                ? x / 4 + (y + r - 1) * 40 + (char far *) 0xb8002000
-                : x / 4 + (y + r) * 40 + (char far *) 0xb8000000;
-            s = src->pixels + src->width / 4 * r;
-            _fmemcpy (d, s, src->width / 4);
-        }
-        
-        /* the other draw operations need doing byte by byte */
-        else 
-            for (b = 0; b < src->width / 4; ++b) {
-                d = b + ((r % 2)
-                    ? x / 4 + (y + r - 1) * 40 + (char far *) 0xb8002000
-                    : x / 4 + (y + r) * 40 + (char far *) 0xb8000000);
-                s = b + src->pixels + src->width / 4 * r;
-                switch (draw) {
-                    case DRAW_PRESET:
-                        *d = ~*s;
-                        break;
-                    case DRAW_AND:
-                        *d &= *s;
-                        break;
-                    case DRAW_OR:
-                        *d |= *s;
-                        break;
-                    case DRAW_XOR:
-                        *d ^= *s;
-                        break;
-                }
-            }
+    for (r = 0; r < src->height; ++r) {
+        d = row_address (x, y + r);
+        s = src->pixels + src->width / 4 * r;
+        put_row (d, s, src->width / 4, draw);
+    }
+}
+
+/**
+ * Put a masked sprite onto the screen in a single pass.
+ * @param dst is the screen to affect.
+ * @param src is the sprite bitmap.
+ * @param mask is the mask bitmap, the same size as the sprite.
+ * @param x is the x coordinate at which the sprite is to be placed.
+ * @param y is the y coordinate at which the sprite is to be placed.
+ * This has the same effect as putting the mask with DRAW_AND and then
+ * the sprite with DRAW_OR, but x need not be a multiple of 4.
+ */
+void scr_putmasked (Screen *dst, Bitmap *src, Bitmap *mask, int x, int y)
+{
+    /* local variables */
+    char far *d; /* address to copy data to */
+    char *s; /* sprite pixels to copy */
+    char *m; /* mask pixels to copy */
+    int r; /* row counter */
+    int bytes; /* bytes per row of the sprite */
+
+    /* dst is not used but here for future proofing */
+    dst = dst; /* shut the compiler up, hopefully */
+
+    /* unaligned sprites use shifted copies that are a byte wider */
+    bytes = src->width / 4;
+    if (x % 4 &&
+        (s = bit_shifted (src, x % 4, 0x00)) &&
+        (m = bit_shifted (mask, x % 4, 0xff)))
+        ++bytes;
+    else {
+        s = src->pixels;
+        m = mask->pixels;
+    }
+
+    /* copy the pixels */
+    for (r = 0; r < src->height; ++r) {
+        d = row_address (x, y + r);
+        put_masked_row (d, s + bytes * r, m + bytes * r, bytes);
+    }
 }
 
 /**
@@ -302,14 +442,44 @@ void scr_get (Screen *src, Bitmap *dst, int x, int y)
 
     /* copy the pixels */
     for (r = 0; r < dst->height; ++r) {
-        s = (r % 2)
-            ? x / 4 + (y + r - 1) * 40 + (char far *) 0xb8002000
-            : x / 4 + (y + r) * 40 + (char far *) 0xb8000000;
+        s = row_address (x, y + r);
         d = dst->pixels + dst->width / 4 * r;
         _fmemcpy (d, s, dst->width / 4);
     }
 }
 
+/**
+ * Write the screen to an already open file as a PPM image.
+ * @param screen is the screen to write.
+ * @param output is the output file handle.
+ * Mode 6 screens are written at 640x200 in black and white.
+ */
+void scr_dump (Screen *screen, FILE *output)
+{
+    /* local variables */
+    unsigned char rgb[4][3]; /* levels for each of the four colours */
+    char far *s; /* address of the screen row */
+    int y; /* row counter */
+    int b; /* byte counter */
+    int p; /* pixel bit position within a byte */
+
+    /* write the header */
+    scr_rgb (screen, rgb);
+    fprintf (output, "P6\n%d 200\n255\n", screen->mode == 6 ? 640 : 320);
+
+    /* write each row, one pixel of each colour, or two in mode 6 */
+    for (y = 0; y < 200; ++y) {
+        s = row_address (0, y);
+        for (b = 0; b < 80; ++b)
+            if (screen->mode == 6)
+                for (p = 7; p >= 0; --p)
+                    fwrite (rgb[3 * ((s[b] >> p) & 1)], 3, 1, output);
+            else
+                for (p = 6; p >= 0; p -= 2)
+                    fwrite (rgb[(s[b] >> p) & 3], 3, 1, output);
+    }
+}
+
 /**
  * Draw a box on the screen, filled in the current ink colour.
  * @param screen is the screen to affect.
@@ -332,9 +502,7 @@ void scr_box (Screen *screen, int x, int y, int width, int height)
 
     /* fill each individual row */
     for (r = 0; r < height; ++r) {
-        d = (r % 2)
-            ? x / 4 + (y + r - 1) * 40 + (char far *) 0xb8002000
-            : x / 4 + (y + r) * 40 + (char far *) 0xb8000000;
+        d = row_address (x, y + r);
         _fmemset (d, v, width / 4);
     }
 }
@@ -352,25 +520,23 @@ void scr_print (Screen *screen, int x, int y, char *message)
     /* local variables */
     int b; /* character pointer */
     int r; /* row of character */
-    char v; /* value of byte in character */
-    char far *d; /* pointer to destination byte on screen */
+    char *glyphs; /* the font's pixels in the current colours */
+    char *s; /* pointer to the character's pixels */
 
     /* only try to print if a font is selected */
     if (! screen->font) return;
 
+    /* use the font in the current colours, or as it is if need be */
+    if (! (glyphs = fnt_coloured (screen->font, screen->ink,
+        screen->paper)))
+        glyphs = screen->font->pixels;
+
     /* print each character */
-    for (b = 0; message[b]; ++b)
-        for (r = 0; r < 8; ++r) {
-            d = b + ((r % 2)
-                ? x / 4 + (y + r - 1) * 40 + (char far *) 0xb8002000
-                : x / 4 + (y + r) * 40 + (char far *) 0xb8000000);
-            v = screen->font->pixels[r + 8
-                * (message[b] - screen->font->first)];
-            if (screen->ink != 3 || screen->paper != 0)
-                v = (v & 0x55 * screen->ink)
-                    | ((0xff ^ v) & 0x55 * screen->paper);
-            *d = v;
-        }
+    for (b = 0; message[b]; ++b) {
+        s = glyphs + 8 * (message[b] - screen->font->first);
+        for (r = 0; r < 8; ++r)
+            *row_address (x + 4 * b, y + r) = s[r];
+    }
 }
 
 /**
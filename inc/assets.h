@@ -0,0 +1,48 @@
+/*======================================================================
+ * Team Droid: Jam Edition
+ * A programming puzzle game with cute robots.
+ *
+ * Copyright (C) Damian Gareth Walker, 2022.
+ * Asset File Header.
+ */
+
+#ifndef __ASSETS_H__
+#define __ASSETS_H__
+
+/*----------------------------------------------------------------------
+ * Constants.
+ */
+
+/** @const ASSETS_FILENAME The name of the asset file. */
+#define ASSETS_FILENAME "tdroid.dat"
+
+/** @const ASSETS_HEADER The header identifying the asset file. */
+#define ASSETS_HEADER "TDR200D"
+
+/** @const ASSETS_ENTRYSIZE The size of a table of contents entry. */
+#define ASSETS_ENTRYSIZE 6
+
+/** @const ASSETS_TOCSIZE The size of the header and table of contents. */
+#define ASSETS_TOCSIZE (8 + ASSETS_ENTRYSIZE * ASSETS_LAST)
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/**
+ * @enum AssetSection
+ * The sections of the asset file, in the order they are stored. The
+ * table of contents after the header gives the offset of each section
+ * from the start of the file (4 bytes) and its size (2 bytes).
+ */
+typedef enum {
+    ASSETS_LOGO, /* the Cyningstan logo */
+    ASSETS_TITLE, /* the title screen */
+    ASSETS_GRAPHICS, /* border, panels, sprites, tiles and dialogue */
+    ASSETS_FONT, /* the font */
+    ASSETS_SOUND, /* the sound effects, 6 bytes each */
+    ASSETS_ROBOTS, /* the packed robot details */
+    ASSETS_LAST /* placeholder */
+} AssetSection;
+
+#endif
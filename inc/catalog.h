@@ -0,0 +1,149 @@
+/*======================================================================
+ * Team Droid: Jam Edition
+ * A programming puzzle game with cute robots.
+ *
+ * Copyright (C) Damian Gareth Walker, 2022.
+ * Catalogue Header.
+ */
+
+/* types defined in this file */
+typedef struct catalogue Catalogue;
+
+#ifndef __CATALOG_H__
+#define __CATALOG_H__
+
+/*----------------------------------------------------------------------
+ * Required Headers.
+ */
+
+/* project specific headers */
+#include "dirindex.h"
+
+/*----------------------------------------------------------------------
+ * Constants.
+ */
+
+/** @const CATALOGUE_PAGESIZE The number of entries held in memory. */
+#define CATALOGUE_PAGESIZE 8
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/**
+ * @enum CatalogueSort
+ * The orders a catalogue can be sorted in.
+ */
+typedef enum {
+    CATALOGUE_NAME, /* alphabetical order of name */
+    CATALOGUE_LASTPLAYED, /* most recently saved first */
+    CATALOGUE_SCORE /* furthest level first, then lowest total */
+} CatalogueSort;
+
+/**
+ * @struct catalogue
+ * A sorted list of the level packs or saved games in a directory
+ * index. Only the record numbers and initials of the whole list are
+ * kept in memory, along with one page of full entries.
+ */
+struct catalogue {
+
+    /*
+     * Attributes
+     */
+
+    /** @var dirindex The directory index listed. */
+    DirIndex *dirindex;
+
+    /** @var type The kind of file listed, a DirIndexType. */
+    int type;
+
+    /** @var sort The order of the list, a CatalogueSort. */
+    int sort;
+
+    /** @var count The number of entries in the list. */
+    int count;
+
+    /** @var records The index record number of each entry in order. */
+    int *records;
+
+    /** @var initials The upper case initial of each entry's name. */
+    char *initials;
+
+    /**
+     * @var packs
+     * For a list of games, the position of each game's level pack in
+     * the level pack list it was built with.
+     */
+    int *packs;
+
+    /** @var first The position of the page in the list, or -1. */
+    int first;
+
+    /** @var page The entries on the page. */
+    DirIndexEntry page[CATALOGUE_PAGESIZE];
+
+    /*
+     * Methods
+     */
+
+    /**
+     * Destroy the catalogue when it is no longer needed.
+     * @param catalogue The catalogue to destroy.
+     */
+    void (*destroy) (Catalogue *catalogue);
+
+    /**
+     * Build the list from the directory index, which must still
+     * hold its entries in memory. Games whose level pack is not in
+     * the level pack list are left out.
+     * @param  catalogue The catalogue to build.
+     * @param  sort      The order to sort the list in.
+     * @param  packs     The level pack list, already built from the
+     *                   same index, or NULL for a level pack list.
+     * @return           1 if successful, 0 on failure.
+     */
+    int (*build) (Catalogue *catalogue, int sort, Catalogue *packs);
+
+    /**
+     * Get an entry from the list, reading in its page if necessary.
+     * The entry is only valid until the next page is read.
+     * @param  catalogue The catalogue.
+     * @param  position  The position of the entry in the list.
+     * @return           The entry, or NULL if it cannot be read.
+     */
+    DirIndexEntry *(*get) (Catalogue *catalogue, int position);
+
+    /**
+     * Find the next entry whose name starts with a letter, going
+     * round to the start of the list if necessary.
+     * @param  catalogue The catalogue to search.
+     * @param  position  The position to search after.
+     * @param  letter    The letter to look for.
+     * @return           The position found, or -1 if there is none.
+     */
+    int (*jump) (Catalogue *catalogue, int position, int letter);
+
+    /**
+     * Find the position of a file in the list.
+     * @param  catalogue The catalogue to search.
+     * @param  filename  The filename to look for.
+     * @return           The position found, or -1 if it is not there.
+     */
+    int (*locate) (Catalogue *catalogue, char *filename);
+
+};
+
+/*----------------------------------------------------------------------
+ * Top Level Function Declarations.
+ */
+
+/**
+ * Construct a new catalogue.
+ * @param  dirindex The directory index to list.
+ * @param  type     The kind of file to list, a DirIndexType.
+ * @return          The new catalogue.
+ */
+Catalogue *new_Catalogue (DirIndex *dirindex, int type);
+
+#endif
@@ -18,8 +18,6 @@ typedef struct cell Cell;
 
 /* required headers */
 #include <stdio.h>
-#include "level.h"
-#include "robot.h"
 
 /**
  * @enum CellTypes
@@ -54,6 +52,10 @@ typedef enum {
     CELL_SHOOT /* an cell has been shot */
 } CellEffectType;
 
+/* headers that need the cell types, as the level has a bitboard each */
+#include "level.h"
+#include "robot.h"
+
 /**
  * @struct cell
  * Model of a single cell on the map.
@@ -79,6 +81,9 @@ struct cell {
     /** @var allowshoot 1 if this cell can be shot, 0 otherwise. */
     int allowshoot;
 
+    /** @var active 1 if the cell has an effect on robots or items. */
+    int active;
+
     /*
      * Methods
      */
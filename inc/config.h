@@ -16,6 +16,18 @@
  * Data Definitions.
  */
 
+/**
+ * @enum PlaybackSpeed
+ * How the action screen plays back a turn.
+ */
+typedef enum {
+    PLAYBACK_NORMAL, /* animate at normal speed */
+    PLAYBACK_FAST, /* animate with shortened delays */
+    PLAYBACK_SKIP, /* show only the end of the turn */
+    PLAYBACK_HOLD, /* animate fast while fire is held */
+    PLAYBACK_LAST /* placeholder */
+} PlaybackSpeed;
+
 /** @struct config The configuration. */
 typedef struct config Config;
 struct config {
@@ -29,6 +41,9 @@ struct config {
     /** @var player The last player to play. */
     char player[14];
 
+    /** @var playback The playback speed for the action screen. */
+    int playback;
+
     /*
      * Public Method Declarations.
      */
@@ -0,0 +1,145 @@
+/*======================================================================
+ * Team Droid: Jam Edition
+ * A programming puzzle game with cute robots.
+ *
+ * Copyright (C) Damian Gareth Walker, 2022.
+ * Directory Index Header.
+ */
+
+/* types defined in this file */
+typedef struct dirindex DirIndex;
+typedef struct dirindexentry DirIndexEntry;
+
+#ifndef __DIRINDEX_H__
+#define __DIRINDEX_H__
+
+/*----------------------------------------------------------------------
+ * Required Headers.
+ */
+
+/* ANSI C headers */
+#include <time.h>
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/**
+ * @enum DirIndexType
+ * The kinds of file kept in the index.
+ */
+typedef enum {
+    DIRINDEX_LEVELPACK, /* a level pack */
+    DIRINDEX_GAME /* a saved game */
+} DirIndexType;
+
+/**
+ * @struct dirindexentry
+ * The summary of one level pack or saved game, with the directory
+ * details used to tell whether the file has changed.
+ */
+struct dirindexentry {
+
+    /** @var filename The filename. */
+    char filename[13];
+
+    /** @var type The kind of file, a DirIndexType. */
+    int type;
+
+    /** @var date The DOS date stamp of the file. */
+    unsigned int date;
+
+    /** @var time The DOS time stamp of the file. */
+    unsigned int time;
+
+    /** @var size The size of the file in bytes. */
+    long size;
+
+    /** @var name The level pack name, or the player of a game. */
+    char name[14];
+
+    /** @var levelpackfile The level pack a game plays. */
+    char levelpackfile[13];
+
+    /** @var levelid The level a game has reached. */
+    int levelid;
+
+    /** @var total The total score of a game. */
+    int total;
+
+    /** @var saved The time a game was last saved. */
+    time_t saved;
+
+};
+
+/**
+ * @struct dirindex
+ * An index of the level packs and saved games in the game directory,
+ * kept in a file so that they need not all be opened to list them.
+ */
+struct dirindex {
+
+    /*
+     * Attributes
+     */
+
+    /** @var count The number of entries in the index. */
+    int count;
+
+    /** @var entries The entries in directory order, or NULL if released. */
+    DirIndexEntry *entries;
+
+    /** @var cached 1 if the index file holds the same entries. */
+    int cached;
+
+    /*
+     * Methods
+     */
+
+    /**
+     * Destroy the index when it is no longer needed.
+     * @param dirindex The index to destroy.
+     */
+    void (*destroy) (DirIndex *dirindex);
+
+    /**
+     * Bring the index up to date with the directory. Only files that
+     * are new or whose date, time or size have changed are opened,
+     * and the index file is only rewritten if something changed.
+     * @param  dirindex The index to refresh.
+     * @return          1 if successful, 0 if the directory is unreadable.
+     */
+    int (*refresh) (DirIndex *dirindex);
+
+    /**
+     * Free the entries held in memory if the index file has them all,
+     * so that they can be read back a few at a time.
+     * @param dirindex The index to release.
+     */
+    void (*release) (DirIndex *dirindex);
+
+    /**
+     * Read some entries, from memory if they are still held there or
+     * from the index file otherwise.
+     * @param  dirindex The index to read from.
+     * @param  records  The record number of each entry to read.
+     * @param  count    The number of entries to read.
+     * @param  entries  The entries to read into.
+     * @return          1 if successful, 0 on failure.
+     */
+    int (*read) (DirIndex *dirindex, int *records, int count,
+		 DirIndexEntry *entries);
+
+};
+
+/*----------------------------------------------------------------------
+ * Top Level Function Declarations.
+ */
+
+/**
+ * Construct a new directory index.
+ * @return The new index.
+ */
+DirIndex *new_DirIndex (void);
+
+#endif
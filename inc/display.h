@@ -20,6 +20,13 @@ typedef struct display Display;
 #include "game.h"
 #include "scoretbl.h"
 
+/*----------------------------------------------------------------------
+ * Constants.
+ */
+
+/** @const DISPLAY_MAXBEAMS The most phaser beams shown at once. */
+#define DISPLAY_MAXBEAMS 32
+
 /*----------------------------------------------------------------------
  * Data Definitions.
  */
@@ -75,6 +82,18 @@ struct display {
      */
     void (*update) (void);
 
+    /**
+     * Start recording the screen to an animated GIF, if enabled.
+     * @param levelid The level being played.
+     * @param turnno  The turn being played.
+     */
+    void (*startcapture) (int levelid, int turnno);
+
+    /**
+     * Stop recording the screen and finish the GIF.
+     */
+    void (*stopcapture) (void);
+
     /**
      * Display a menu and get an option from it.
      * @param count   The number of options in the menu.
@@ -116,6 +135,13 @@ struct display {
      */
     void (*showlevelmap) (Level *level);
 
+    /**
+     * Show the squares of a level that have changed since they were
+     * last drawn.
+     * @param level The level to show.
+     */
+    void (*showlevelmapchanges) (Level *level);
+
     /**
      * Make a sound.
      * @param id The ID of the sound.
@@ -278,19 +304,20 @@ struct display {
     void (*showactionscreen) (Level *level);
 
     /**
-     * Show a phaser beam in transit.
-     * @param x The x position of the beam.
-     * @param y The y position of the beam.
+     * Show a phaser beam in transit, saving the screen behind it.
+     * @param beam   The beam number, below DISPLAY_MAXBEAMS.
+     * @param x      The x position of the beam in pixels across the map.
+     * @param y      The y position of the beam in pixels down the map.
      * @param facing 0 for north/south, 1 for east/west.
      */
-    void (*showphaserbeam) (int x, int y, int facing);
+    void (*showphaserbeam) (int beam, int x, int y, int facing);
 
     /**
-     * Hide a phaser beam by redisplaying the level map square
-     * @param level    The level to show.
-     * @param location The location to show.
+     * Hide a phaser beam by restoring the screen saved behind it.
+     * Overlapping beams must be hidden in the reverse order.
+     * @param beam The beam number.
      */
-    void (*hidephaserbeam) (Level *level, int location);
+    void (*hidephaserbeam) (int beam);
 
     /**
      * Show a blast as a phaser beam hits something.
@@ -315,8 +342,9 @@ struct display {
  * Display constructor.
  * @param colourset = 0 for mono, 1 for colour, 2 for nice colour.
  * @param quiet = 0 for sound and music, 1 for silence.
+ * @param record = 1 to record action playback as animated GIFs.
  * @return the new display.
  */
-Display *new_Display (int colourset, int quiet);
+Display *new_Display (int colourset, int quiet, int record);
 
 #endif
@@ -0,0 +1,227 @@
+/*======================================================================
+ * Team Droid: Jam Edition
+ * A programming puzzle game with cute robots.
+ *
+ * Copyright (C) Damian Gareth Walker, 2022.
+ * Turn Resolution Engine Header.
+ */
+
+/* types defined in this file */
+typedef struct event Event;
+typedef struct eventlist EventList;
+
+#ifndef __ENGINE_H__
+#define __ENGINE_H__
+
+/*----------------------------------------------------------------------
+ * Required Headers.
+ */
+
+/* project specific headers */
+#include "level.h"
+#include "robot.h"
+
+/*----------------------------------------------------------------------
+ * Constants.
+ */
+
+/**
+ * @const ENGINE_MAXEVENTS The most events one phase can record: the
+ * start of the phase, then for each map cell one action, shot or
+ * effect, one destroyed robot and one destroyed item.
+ */
+#define ENGINE_MAXEVENTS (1 + 3 * 192)
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/**
+ * @enum EnginePhase
+ * The phases of a single move, in the order they are resolved.
+ */
+typedef enum {
+    ENGINE_SPRINT, /* first step of any sprint actions */
+    ENGINE_SPRINTEFFECTS, /* cell effects on sprinting robots */
+    ENGINE_GENERAL, /* all actions except shooting */
+    ENGINE_SHOOT, /* shoot actions */
+    ENGINE_EFFECTS, /* cell effects on everything */
+    ENGINE_PHASES /* number of phases in a move */
+} EnginePhase;
+
+/**
+ * @enum EventType
+ * The things that can happen during a move.
+ */
+typedef enum {
+    EVENT_NONE, /* no event */
+    EVENT_PHASE, /* start of a phase: x is the move, value the phase */
+    EVENT_ACTION, /* robot at x,y performs action in value */
+    EVENT_EFFECT, /* cell of type value at x,y has an effect */
+    EVENT_TELEPORT, /* teleporter at x,y sends something away */
+    EVENT_SHOT, /* phaser beam from x,y going in facing value */
+    EVENT_DESTROYROBOT, /* robot at x,y is destroyed */
+    EVENT_DESTROYITEM /* item at x,y is destroyed */
+} EventType;
+
+/**
+ * @struct event
+ * A single thing that happened during a turn.
+ */
+struct event {
+
+    /** @var type The event type. */
+    unsigned char type;
+
+    /** @var x The x coordinate where the event happened. */
+    unsigned char x;
+
+    /** @var y The y coordinate where the event happened. */
+    unsigned char y;
+
+    /** @var value The action, cell type, facing or phase. */
+    unsigned char value;
+
+    /** @var range Number of squares a phaser beam crosses. */
+    unsigned char range;
+
+    /** @var hit 1 if a phaser beam hits something at the end. */
+    unsigned char hit;
+
+};
+
+/**
+ * @struct eventlist
+ * A list of events recorded by the engine.
+ */
+struct eventlist {
+
+    /*
+     * Attributes
+     */
+
+    /** @var events The events recorded. */
+    Event *events;
+
+    /** @var count The number of events recorded. */
+    int count;
+
+    /** @var size The number of events there is room for. */
+    int size;
+
+    /*
+     * Methods
+     */
+
+    /**
+     * Destroy the event list when it is no longer needed.
+     * @param events The event list to destroy.
+     */
+    void (*destroy) (EventList *events);
+
+    /**
+     * Clear the event list, keeping its memory for reuse.
+     * @param events The event list to clear.
+     */
+    void (*clear) (EventList *events);
+
+    /**
+     * Add an event to the list.
+     * @param  events The event list.
+     * @param  type   The event type.
+     * @param  x      The x coordinate of the event.
+     * @param  y      The y coordinate of the event.
+     * @param  value  The event value.
+     * @return        A pointer to the new event.
+     */
+    Event *(*add) (EventList *events, int type, int x, int y,
+		   int value);
+
+};
+
+/*----------------------------------------------------------------------
+ * Top Level Function Declarations.
+ */
+
+/**
+ * Construct a new event list, with room for the events of a phase.
+ * @return The new event list.
+ */
+EventList *new_EventList (void);
+
+/**
+ * Put the robots on a level into priority order. The order depends
+ * only on the level layout, so a replay will always match.
+ * @param  level  The level containing the robots.
+ * @param  robots An array with room for every robot on the level.
+ * @return        The number of robots placed in the array.
+ */
+int simulate_priorities (Level *level, Robot **robots);
+
+/**
+ * Resolve one phase of a move. Destroyed robots are removed from the
+ * level and their entries in the robot list are set to NULL.
+ * @param  level      The level to play on.
+ * @param  robots     The robots in priority order.
+ * @param  robotcount The number of entries in the robot list.
+ * @param  move       The move number, 0 to 7.
+ * @param  phase      The phase to resolve.
+ * @param  events     The list to record events on, or NULL.
+ * @return            Nonzero if any actions or effects happened.
+ */
+int simulate_phase (Level *level, Robot **robots, int robotcount,
+		    int move, int phase, EventList *events);
+
+/**
+ * Resolve all the phases of a single move.
+ * @param  level      The level to play on.
+ * @param  robots     The robots in priority order.
+ * @param  robotcount The number of entries in the robot list.
+ * @param  move       The move number, 0 to 7.
+ * @param  events     The list to record events on, or NULL.
+ * @return            Nonzero if any actions or effects happened.
+ */
+int simulate_move (Level *level, Robot **robots, int robotcount,
+		   int move, EventList *events);
+
+/**
+ * Tidy up the level at the end of a turn, removing destroyed items
+ * and resetting the status of the others.
+ * @param level The level to tidy up.
+ */
+void simulate_endturn (Level *level);
+
+/**
+ * Resolve a whole turn of eight moves.
+ * @param level      The level to play on.
+ * @param robots     The robots in priority order.
+ * @param robotcount The number of entries in the robot list.
+ * @param events     The list to record events on, or NULL.
+ */
+void simulate_turn (Level *level, Robot **robots, int robotcount,
+		    EventList *events);
+
+/**
+ * Check if a level is complete, with a card on every reader.
+ * @param  level The level to check.
+ * @return       1 if the level is complete, 0 if not.
+ */
+int simulate_complete (Level *level);
+
+/**
+ * Check if a level is failed, with no player robots left or too few
+ * data cards for the readers.
+ * @param  level The level to check.
+ * @return       1 if the level is failed, 0 if not.
+ */
+int simulate_failed (Level *level);
+
+/**
+ * Calculate a hash of the state of a level, for checking that a
+ * replay has reached the same position as the original game.
+ * @param  level The level to hash.
+ * @return       The hash value.
+ */
+unsigned long simulate_hash (Level *level);
+
+#endif
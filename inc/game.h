@@ -17,6 +17,7 @@ typedef struct game Game;
  */
 
 /* required headers */
+#include <time.h>
 #include "level.h"
 #include "levelpak.h"
 #include "action.h"
@@ -49,6 +50,15 @@ struct game {
     /** @var turnno The current turn number. */
     int turnno;
 
+    /** @var deployed 1 if robots were deployed since the last turn. */
+    int deployed;
+
+    /** @var total The total score when the game was last saved. */
+    int total;
+
+    /** @var saved The time the game was last saved. */
+    time_t saved;
+
     /** @var level_pack The level pack in use. */
     LevelPack *levelpack;
 
@@ -88,7 +98,9 @@ struct game {
     int (*save) (Game *game);
 
     /**
-     * Load a game. The filename is taken from the attributes.
+     * Load a game. The filename is taken from the attributes. The
+     * summary is the player, level pack, level reached, total score
+     * and time saved, which are kept at the start of the file.
      * @param  game    The game to load.
      * @param  summary 0 to load the full game, 1 for summary only.
      * @return         1 if successful, 0 on failure.
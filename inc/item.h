@@ -27,7 +27,8 @@ typedef enum {
     ITEM_SPRING, /* a spring to allow leaping */
     ITEM_PHASER, /* a phaser to allow shooting */
     ITEM_CRATE, /* a crate that can block movement and shooting */
-    ITEM_CARD /* a data card to win the game */
+    ITEM_CARD, /* a data card to win the game */
+    ITEM_LAST /* placeholder */
 } ItemType;
 
 /**
@@ -0,0 +1,165 @@
+/*======================================================================
+ * Team Droid: Jam Edition
+ * A programming puzzle game with cute robots.
+ *
+ * Copyright (C) Damian Gareth Walker, 2022.
+ * Replay Journal Header.
+ */
+
+/* types defined in this file */
+typedef struct journal Journal;
+typedef struct journalturn JournalTurn;
+
+#ifndef __JOURNAL_H__
+#define __JOURNAL_H__
+
+/*----------------------------------------------------------------------
+ * Required Headers.
+ */
+
+/* ANSI C headers */
+#include <stdio.h>
+
+/*----------------------------------------------------------------------
+ * Constants.
+ */
+
+/**
+ * @const JOURNAL_MAXROBOTS The most robots recorded for one turn: one
+ * on every cell of the map, so that every turn can be recorded.
+ */
+#define JOURNAL_MAXROBOTS 192
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/**
+ * @struct journalturn
+ * Everything needed to play one turn back through the engine.
+ */
+struct journalturn {
+
+    /** @var levelid The level being played. */
+    int levelid;
+
+    /** @var turnno The turn number within the level. */
+    int turnno;
+
+    /** @var deployed 1 if the turn follows a deployment of robots. */
+    int deployed;
+
+    /** @var library The action types in the library this turn. */
+    int library[12];
+
+    /** @var robotcount The number of robots on the level. */
+    int robotcount;
+
+    /*
+     * The robots in priority order, as they were at the start of the
+     * turn. Storing the order rather than the seed keeps a journal
+     * valid on a C library whose rand() differs from the game's.
+     */
+
+    /** @var types The type of each robot. */
+    int types[JOURNAL_MAXROBOTS];
+
+    /** @var locations The map location of each robot. */
+    int locations[JOURNAL_MAXROBOTS];
+
+    /** @var facings The facing of each robot. */
+    int facings[JOURNAL_MAXROBOTS];
+
+    /** @var ram The program in each robot's RAM. */
+    int ram[JOURNAL_MAXROBOTS][8];
+
+    /** @var hash The state hash of the level at the end of the turn. */
+    unsigned long hash;
+
+};
+
+/**
+ * @struct journal
+ * A record of every turn played in a game, kept beside the save.
+ */
+struct journal {
+
+    /*
+     * Attributes
+     */
+
+    /** @var filename The filename of the journal. */
+    char filename[13];
+
+    /** @var levelpackfile The file name of the level pack. */
+    char levelpackfile[13];
+
+    /** @var input The file handle while the journal is being read. */
+    FILE *input;
+
+    /*
+     * Methods
+     */
+
+    /**
+     * Destroy the journal when it is no longer needed.
+     * @param journal The journal to destroy.
+     */
+    void (*destroy) (Journal *journal);
+
+    /**
+     * Set the journal filename to match a game filename.
+     * @param journal  The journal.
+     * @param gamefile The filename of the game.
+     */
+    void (*setgame) (Journal *journal, char *gamefile);
+
+    /**
+     * Start a new journal, replacing any old one.
+     * @param  journal The journal to create.
+     * @return         1 if successful, 0 on failure.
+     */
+    int (*create) (Journal *journal);
+
+    /**
+     * Add a turn to the end of the journal, creating it if necessary.
+     * @param  journal The journal.
+     * @param  turn    The turn to add.
+     * @return         1 if successful, 0 on failure.
+     */
+    int (*append) (Journal *journal, JournalTurn *turn);
+
+    /**
+     * Open the journal for reading and read its header.
+     * @param  journal The journal.
+     * @return         1 if successful, 0 on failure.
+     */
+    int (*open) (Journal *journal);
+
+    /**
+     * Read the next turn from an open journal.
+     * @param  journal The journal.
+     * @param  turn    The turn to read into.
+     * @return         1 if successful, 0 at the end of the journal.
+     */
+    int (*read) (Journal *journal, JournalTurn *turn);
+
+    /**
+     * Close a journal that was opened for reading.
+     * @param journal The journal.
+     */
+    void (*close) (Journal *journal);
+
+};
+
+/*----------------------------------------------------------------------
+ * Top Level Function Declarations.
+ */
+
+/**
+ * Construct a new journal.
+ * @return The new journal.
+ */
+Journal *new_Journal (void);
+
+#endif
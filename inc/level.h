@@ -8,6 +8,7 @@
 
 /* types defined in this file */
 typedef struct level Level;
+typedef struct levelsnapshot LevelSnapshot;
 
 #ifndef __LEVEL_H__
 #define __LEVEL_H__
@@ -24,6 +25,13 @@ typedef struct level Level;
 #include "robot.h"
 #include "item.h"
 
+/*----------------------------------------------------------------------
+ * Constants.
+ */
+
+/** @def LEVEL_BIT The bit for a location in its row of a bitboard. */
+#define LEVEL_BIT(location) (1U << ((location) % 16))
+
 /*----------------------------------------------------------------------
  * Data Definitions.
  */
@@ -47,16 +55,63 @@ struct level {
     /** @var robots Pointers to robots on each cell. */
     Robot *robots[192];
 
+    /*
+     * Bitboards have one word per row, with bit x set for column x.
+     * They are kept in step with the arrays above by the set and move
+     * methods, which should be used for any change to the map.
+     */
+
+    /** @var cellmasks A bitboard for each cell type. */
+    unsigned int cellmasks[CELL_LAST][12];
+
+    /** @var itemmasks A bitboard for each item type. */
+    unsigned int itemmasks[ITEM_LAST][12];
+
+    /** @var playermask A bitboard of the player robots. */
+    unsigned int playermask[12];
+
+    /** @var guardmask A bitboard of the guard robots. */
+    unsigned int guardmask[12];
+
+    /**
+     * @var teleports
+     * The destination of each teleporter. Other cells, and teleporters
+     * with nowhere to go, have their own location. Valid only when
+     * teleportsfound is set; use the teleport method to be sure.
+     */
+    unsigned char teleports[192];
+
+    /** @var teleportsfound 1 if the teleports table is up to date. */
+    int teleportsfound;
+
+    /**
+     * @var active
+     * The locations of cells that have effects on robots or items, in
+     * map order. Kept up to date by the setcell method.
+     */
+    unsigned char active[192];
+
+    /** @var activecount The number of entries in the active list. */
+    int activecount;
+
+    /*
+     * The counters below are also kept up to date by the set and move
+     * methods, so that the game can be won or lost without a scan.
+     */
+
     /** @var readers The number of card readers on the level. */
     int readers;
 
-    /** @var cards The number of data cards placed. */
+    /** @var cards The number of data cards on the level. */
     int cards;
 
+    /** @var cardsread The number of card readers holding a card. */
+    int cardsread;
+
     /** @var spawners The number of robots to be placed. */
     int spawners;
 
-    /** @var robotcount The number of robots present. */
+    /** @var robotcount The number of player robots present. */
     int robotcount;
 
     /** @var turns The number of turns taken on this level. */
@@ -79,6 +134,28 @@ struct level {
      */
     Level *(*clone) (Level *level);
 
+    /**
+     * Make the level an exact copy of another, reusing its memory.
+     * @param level  The level to overwrite.
+     * @param source The level to copy.
+     */
+    void (*copy) (Level *level, Level *source);
+
+    /**
+     * Take a snapshot of the level in a single block of memory.
+     * @param  level    The level to take a snapshot of.
+     * @param  snapshot An old snapshot to reuse, or NULL.
+     * @return          The snapshot, to be freed with free().
+     */
+    LevelSnapshot *(*snapshot) (Level *level, LevelSnapshot *snapshot);
+
+    /**
+     * Restore the level from a snapshot.
+     * @param level    The level to restore.
+     * @param snapshot The snapshot to restore it from.
+     */
+    void (*restore) (Level *level, LevelSnapshot *snapshot);
+
     /**
      * Clear the level.
      * @param  level The level to clear.
@@ -101,6 +178,110 @@ struct level {
      */
     int (*read) (Level *level, FILE *output);
 
+    /**
+     * Write the level to an already open file in packed form, with
+     * its length first so that it can be read in one go.
+     * @param  level  The level to write.
+     * @param  output The output file handle.
+     * @return        1 if successful, 0 on failure.
+     */
+    int (*writepacked) (Level *level, FILE *output);
+
+    /**
+     * Read a packed level from an already open file.
+     * @param  level The level to read.
+     * @param  input The input file handle.
+     * @return       1 if successful, 0 on failure.
+     */
+    int (*readpacked) (Level *level, FILE *input);
+
+    /**
+     * Set the cell type at a location.
+     * @param level    The level to change.
+     * @param location The location on the map.
+     * @param cell     The new cell type.
+     */
+    void (*setcell) (Level *level, int location, Cell *cell);
+
+    /**
+     * Put an item at a location, or remove one if item is NULL. Any
+     * item removed is not destroyed.
+     * @param level    The level to change.
+     * @param location The location on the map.
+     * @param item     The item to place, or NULL.
+     */
+    void (*setitem) (Level *level, int location, Item *item);
+
+    /**
+     * Put a robot at a location, or remove one if robot is NULL. Any
+     * robot removed is not destroyed.
+     * @param level    The level to change.
+     * @param location The location on the map.
+     * @param robot    The robot to place, or NULL.
+     */
+    void (*setrobot) (Level *level, int location, Robot *robot);
+
+    /**
+     * Move an item to an empty location.
+     * @param level  The level to change.
+     * @param origin The location of the item.
+     * @param dest   The location to move it to.
+     */
+    void (*moveitem) (Level *level, int origin, int dest);
+
+    /**
+     * Move a robot, and any item it carries, to an empty location.
+     * The robot's own coordinates are updated.
+     * @param level  The level to change.
+     * @param origin The location of the robot.
+     * @param dest   The location to move it to.
+     */
+    void (*moverobot) (Level *level, int origin, int dest);
+
+    /**
+     * Find where a teleporter sends things: the nearest other
+     * teleporter, with ties going to the first in map order.
+     * @param  level    The level.
+     * @param  location The location of the teleporter.
+     * @return          The destination, or location if there is none.
+     */
+    int (*teleport) (Level *level, int location);
+
+};
+
+/**
+ * @struct levelsnapshot
+ * The changing state of a level, kept small enough to take and restore
+ * every turn. Bitboards and counters are rebuilt on restoring.
+ */
+struct levelsnapshot {
+
+    /** @var size The number of bytes reserved for the snapshot. */
+    size_t size;
+
+    /** @var turns The number of turns taken on the level. */
+    int turns;
+
+    /** @var robotcount The number of robots in the snapshot. */
+    int robotcount;
+
+    /**
+     * @var squares
+     * The cell type of each square in the low nibble, and the type of
+     * any item on it in the high nibble.
+     */
+    unsigned char squares[192];
+
+    /** @var itemstatus The status of the item on each square. */
+    unsigned char itemstatus[192];
+
+    /**
+     * @var robots
+     * The robots in map order, stored after the snapshot. Each has its
+     * location and status followed by the robot in packed form.
+     */
+    unsigned char *robots;
+
 };
 
 /*----------------------------------------------------------------------
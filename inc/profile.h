@@ -0,0 +1,148 @@
+/*======================================================================
+ * Team Droid: Jam Edition
+ * A programming puzzle game with cute robots.
+ *
+ * Copyright (C) Damian Gareth Walker, 2022.
+ * Profiling Header.
+ */
+
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+/* required headers */
+#include <stddef.h>
+#include <stdlib.h>
+#include <malloc.h>
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/**
+ * @enum ProfileId
+ * The things that are counted and timed. The first five are the
+ * engine phases of a move, in EnginePhase order.
+ */
+typedef enum {
+    PROFILE_SPRINT, /* the sprint phase, including animation */
+    PROFILE_SPRINTEFFECTS, /* cell effects on sprinting robots */
+    PROFILE_GENERAL, /* general actions */
+    PROFILE_SHOOT, /* shooting, including the phaser animation */
+    PROFILE_EFFECTS, /* cell effects on everything */
+    PROFILE_RULES, /* resolving the rules in the engine */
+    PROFILE_SHOWLEVELMAP, /* redrawing the level map */
+    PROFILE_UPDATE, /* copying changed areas to the screen */
+    PROFILE_BLIT, /* cgalib blits to the screen */
+    PROFILE_SOUND, /* starting sound effects */
+    PROFILE_DELAY, /* deliberate animation delays */
+    PROFILE_LAST /* placeholder */
+} ProfileId;
+
+/*
+ * The profiling calls are compiled only into debug builds, so that
+ * they cost nothing in a release build.
+ */
+#ifdef DEBUG
+#define PROFILE_OPEN(filename) profile_open (filename)
+#define PROFILE_CLOSE() profile_close ()
+#define PROFILE_START(id) profile_start (id)
+#define PROFILE_STOP(id) profile_stop (id)
+#define PROFILE_REPORT(levelid, turnno) profile_report (levelid, turnno)
+#define PROFILE_ALLOCATIONS() profile_allocations ()
+#define PROFILE_HEAPBLOCKS() profile_heapblocks ()
+#else
+#define PROFILE_OPEN(filename)
+#define PROFILE_CLOSE()
+#define PROFILE_START(id)
+#define PROFILE_STOP(id)
+#define PROFILE_REPORT(levelid, turnno)
+#define PROFILE_ALLOCATIONS() 0L
+#define PROFILE_HEAPBLOCKS() 0
+#endif
+
+/*
+ * Debug builds also count the heap allocations made by the project's
+ * modules, so that hot paths can be checked for them. The makefile
+ * includes this header in every module of a debug build; the standard
+ * headers are included first so that their declarations are left
+ * alone. The libraries cannot be counted this way, but the blocks
+ * they leave in use on the heap can be counted instead.
+ */
+#ifdef DEBUG
+#define malloc(size) profile_malloc (size)
+#define calloc(count, size) profile_calloc (count, size)
+#define realloc(block, size) profile_realloc (block, size)
+#endif
+
+/*----------------------------------------------------------------------
+ * Top Level Function Declarations.
+ */
+
+/**
+ * Start profiling, setting up the clock and opening the log file.
+ * @param filename The name of the log file.
+ */
+void profile_open (char *filename);
+
+/**
+ * Stop profiling, restoring the clock and closing the log file.
+ */
+void profile_close (void);
+
+/**
+ * Start timing something.
+ * @param id The thing to time.
+ */
+void profile_start (int id);
+
+/**
+ * Stop timing something, adding the time taken to its totals.
+ * @param id The thing being timed.
+ */
+void profile_stop (int id);
+
+/**
+ * Write the counts, times and histograms gathered since the last
+ * report to the log file, then reset them.
+ * @param levelid The level being played.
+ * @param turnno  The turn being played.
+ */
+void profile_report (int levelid, int turnno);
+
+/**
+ * Allocate memory, counting the allocation.
+ * @param  size The number of bytes to allocate.
+ * @return      The memory allocated, or NULL on failure.
+ */
+void *profile_malloc (size_t size);
+
+/**
+ * Allocate cleared memory, counting the allocation.
+ * @param  count The number of items to allocate.
+ * @param  size  The size of each item in bytes.
+ * @return       The memory allocated, or NULL on failure.
+ */
+void *profile_calloc (size_t count, size_t size);
+
+/**
+ * Resize allocated memory, counting the allocation.
+ * @param  block The memory to resize, or NULL.
+ * @param  size  The new size in bytes.
+ * @return       The memory allocated, or NULL on failure.
+ */
+void *profile_realloc (void *block, size_t size);
+
+/**
+ * Find out how many heap allocations have been counted.
+ * @return The number of allocations.
+ */
+unsigned long profile_allocations (void);
+
+/**
+ * Count the blocks in use on the heap, which include those allocated
+ * by the libraries.
+ * @return The number of blocks in use.
+ */
+unsigned int profile_heapblocks (void);
+
+#endif
@@ -24,6 +24,13 @@ typedef struct robot Robot;
 #include "level.h"
 #include "action.h"
 
+/*----------------------------------------------------------------------
+ * Constants.
+ */
+
+/** @const ROBOT_PACKEDSIZE The size of a robot packed into memory. */
+#define ROBOT_PACKEDSIZE 21
+
 /*----------------------------------------------------------------------
  * Data Definitions.
  */
@@ -160,6 +167,21 @@ struct robot {
      */
     int (*read) (Robot *robot, FILE *output);
 
+    /**
+     * Pack the robot into ROBOT_PACKEDSIZE bytes of memory. Its
+     * location is not included.
+     * @param robot  The robot to pack.
+     * @param packed The memory to pack it into.
+     */
+    void (*pack) (Robot *robot, unsigned char *packed);
+
+    /**
+     * Unpack the robot from memory.
+     * @param robot  The robot to unpack.
+     * @param packed The memory to unpack it from.
+     */
+    void (*unpack) (Robot *robot, unsigned char *packed);
+
     /**
      * Perform an action.
      * @param robot  The robot to act.
@@ -181,4 +203,12 @@ struct robot {
  */
 Robot *new_Robot (int type);
 
+/**
+ * Construct a robot with the standard stats for its type. These are
+ * the stats written to the asset file for the game to use.
+ * @param  type The robot type 1..7.
+ * @return      The new robot.
+ */
+Robot *new_StandardRobot (int type);
+
 #endif
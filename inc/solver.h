@@ -0,0 +1,156 @@
+/*======================================================================
+ * Team Droid: Jam Edition
+ * A programming puzzle game with cute robots.
+ *
+ * Copyright (C) Damian Gareth Walker, 2022.
+ * Level Solver Header.
+ */
+
+/* types defined in this file */
+typedef struct solver Solver;
+
+#ifndef __SOLVER_H__
+#define __SOLVER_H__
+
+/*----------------------------------------------------------------------
+ * Required Headers.
+ */
+
+/* standard C headers */
+#include <limits.h>
+
+/* project specific headers */
+#include "level.h"
+
+/*----------------------------------------------------------------------
+ * Constants.
+ */
+
+/** @const SOLVER_MAXTURNS The longest solution the solver looks for. */
+#define SOLVER_MAXTURNS 32
+
+/** @const SOLVER_MAXSPAWNERS The most spawners a level can have. */
+#define SOLVER_MAXSPAWNERS 6
+
+/*
+ * A 16-bit build keeps its table of searched states in conventional
+ * memory, while a host build can afford one sized to the levels' real
+ * state space.
+ */
+#if UINT_MAX == 0xffffU
+
+/** @const SOLVER_MAXSTATES The most states the solver can remember. */
+#define SOLVER_MAXSTATES 65536L
+
+/** @const SOLVER_DEFAULTSTATES The states remembered by default. */
+#define SOLVER_DEFAULTSTATES 16384L
+
+#else
+
+/** @const SOLVER_MAXSTATES The most states the solver can remember. */
+#define SOLVER_MAXSTATES 16777216L
+
+/** @const SOLVER_DEFAULTSTATES The states remembered by default. */
+#define SOLVER_DEFAULTSTATES 4194304L
+
+#endif
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/**
+ * @enum SolverResult
+ * The outcome of a search. The game shuffles the library for each
+ * level, so the solver lets every robot use any library action on any
+ * turn. A par is then the fewest turns under the kindest order, and a
+ * level found unsolvable is unsolvable under every order.
+ */
+typedef enum {
+    SOLVER_SOLVED, /* a shortest solution with any library order */
+    SOLVER_UNSOLVABLE, /* every line of play fails with any order */
+    SOLVER_GAVEUP, /* the time or turn limit was reached */
+    SOLVER_TOOBIG /* too many spawners or robots to search */
+} SolverResult;
+
+/**
+ * @struct solver
+ * An iterative deepening search for the shortest solution to a level.
+ */
+struct solver {
+
+    /*
+     * Settings
+     */
+
+    /** @var timelimit The number of seconds allowed per level. */
+    int timelimit;
+
+    /** @var maxturns The number of turns to search before giving up. */
+    int maxturns;
+
+    /** @var maxstates The number of searched states to remember. */
+    long maxstates;
+
+    /*
+     * Results
+     */
+
+    /** @var result The outcome of the last search. */
+    int result;
+
+    /** @var turns Turns in the solution, or turns fully searched. */
+    int turns;
+
+    /** @var states The number of states searched. */
+    long states;
+
+    /** @var forgotten States forgotten because the table was full. */
+    long forgotten;
+
+    /** @var spawnercount The number of spawners on the level. */
+    int spawnercount;
+
+    /** @var spawners The map location of each spawner. */
+    int spawners[SOLVER_MAXSPAWNERS];
+
+    /** @var deployment The robot type deployed on each spawner, or 0. */
+    int deployment[SOLVER_MAXSPAWNERS];
+
+    /**
+     * @var programs
+     * The RAM of each player robot type for each turn of the solution.
+     */
+    int programs[SOLVER_MAXTURNS][6][8];
+
+    /*
+     * Methods
+     */
+
+    /**
+     * Destroy the solver when it is no longer needed.
+     * @param solver The solver to destroy.
+     */
+    void (*destroy) (Solver *solver);
+
+    /**
+     * Search for the shortest solution to a level.
+     * @param  solver The solver.
+     * @param  level  The level in its initial state.
+     * @return        The search result.
+     */
+    int (*solve) (Solver *solver, Level *level);
+
+};
+
+/*----------------------------------------------------------------------
+ * Top Level Function Declarations.
+ */
+
+/**
+ * Construct a new solver.
+ * @return The new solver.
+ */
+Solver *new_Solver (void);
+
+#endif
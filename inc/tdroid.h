@@ -37,10 +37,10 @@ Display *getdisplay (void);
 Config *getconfig (void);
 
 /**
- * Load the robots from the already-open asset file.
- * @param input The asset file handle.
+ * Load the robots from the asset data.
+ * @param packed The packed player robots followed by the guard robot.
  */
-void loadrobotdetails (FILE *input);
+void loadrobotdetails (unsigned char *packed);
 
 /**
  * Create a new player robot and populate its details.
@@ -21,7 +21,8 @@ typedef struct timer Timer;
 
 /**
  * @struct timer
- * Object to time things.
+ * Object to time things. Timers are small enough to live on the
+ * stack, so starting one never allocates memory.
  */
 struct timer {
 
@@ -29,16 +30,17 @@ struct timer {
     struct timeb end;
 
     /**
-     * Destroy the timer without waiting for it to end.
-     * @param timer The timer to destroy.
+     * Wait for the timer to complete.
+     * @param timer The timer to wait for.
      */
-    void (*destroy) (Timer *timer);
+    void (*wait) (Timer *timer);
 
     /**
-     * Wait for the timer to complete, then destroy it.
-     * @param timer The timer to destroy.
+     * Find out how long is left before the timer ends.
+     * @param  timer The timer.
+     * @return       The milliseconds remaining, or 0 if it has ended.
      */
-    void (*wait) (Timer *timer);
+    int (*remaining) (Timer *timer);
 
 };
 
@@ -47,10 +49,10 @@ struct timer {
  */
 
 /**
- * Create a new timer and set it going.
- * @param  milliseconds The length of the timer.
- * @return              The new timer.
+ * Set a timer going.
+ * @param timer        The timer to start.
+ * @param milliseconds The length of the timer.
  */
-Timer *new_Timer (int milliseconds);
+void start_Timer (Timer *timer, int milliseconds);
 
 #endif
@@ -135,10 +135,10 @@ static int stepforward (Action *action, Robot *robot, Level *level)
     /* are we pushing an item? */
     if (level->items[xd + 16 * yd]) {
 	pushing = 1;
-	if (level->items[xp + 16 * yp])
-	    return 0; /* cannot push two items in a row */
 	if (xp < 0 || xp > 15 || yp < 0 || yp > 11)
 	    return 0; /* cannot move off the map */
+	if (level->items[xp + 16 * yp])
+	    return 0; /* cannot push two items in a row */
 	if (! level->cells[xp + 16 * yp]->allowput)
 	    return 0; /* cannot push onto certain blocks */
 	if (level->robots[xp + 16 * yp])
@@ -147,13 +147,8 @@ static int stepforward (Action *action, Robot *robot, Level *level)
 
     /* move robot in specified direction */
     if (pushing)
-	level->items[xp + 16 * yp] = level->items[xd + 16 * yd];
-    level->robots[xd + 16 * yd] = robot;
-    level->robots[xo + 16 * yo] = NULL;
-    level->items[xd + 16 * yd] = level->items[xo + 16 * yo];
-    level->items[xo + 16 * yo] = NULL;
-    robot->x = xd;
-    robot->y = yd;
+	level->moveitem (level, xd + 16 * yd, xp + 16 * yp);
+    level->moverobot (level, xo + 16 * yo, xd + 16 * yd);
 
     /* return success */
     return 1;
@@ -192,12 +187,7 @@ static int stepbackward (Action *action, Robot *robot, Level *level)
 	return 0; /* cannot push items backwards */
 
     /* move robot in specified direction */
-    level->robots[xd + 16 * yd] = robot;
-    level->robots[xo + 16 * yo] = NULL;
-    level->items[xd + 16 * yd] = level->items[xo + 16 * yo];
-    level->items[xo + 16 * yo] = NULL;
-    robot->x = xd;
-    robot->y = yd;
+    level->moverobot (level, xo + 16 * yo, xd + 16 * yd);
 
     /* return success */
     return 1;
@@ -238,12 +228,7 @@ static int stepleft (Action *action, Robot *robot, Level *level)
 	return 0; /* cannot push items aside */
 
     /* move robot in specified direction */
-    level->robots[xd + 16 * yd] = robot;
-    level->robots[xo + 16 * yo] = NULL;
-    level->items[xd + 16 * yd] = level->items[xo + 16 * yo];
-    level->items[xo + 16 * yo] = NULL;
-    robot->x = xd;
-    robot->y = yd;
+    level->moverobot (level, xo + 16 * yo, xd + 16 * yd);
 
     /* return success */
     return 1;
@@ -284,12 +269,7 @@ static int stepright (Action *action, Robot *robot, Level *level)
 	return 0; /* cannot push items aside */
 
     /* move robot in specified direction */
-    level->robots[xd + 16 * yd] = robot;
-    level->robots[xo + 16 * yo] = NULL;
-    level->items[xd + 16 * yd] = level->items[xo + 16 * yo];
-    level->items[xo + 16 * yo] = NULL;
-    robot->x = xd;
-    robot->y = yd;
+    level->moverobot (level, xo + 16 * yo, xd + 16 * yd);
 
     /* return success */
     return 1;
@@ -354,12 +334,7 @@ static int leap (Action *action, Robot *robot, Level *level)
 	return 0; /* cannot leap on to items */
 
     /* move robot in specified direction */
-    level->robots[xd + 16 * yd] = robot;
-    level->robots[xo + 16 * yo] = NULL;
-    level->items[xd + 16 * yd] = level->items[xo + 16 * yo];
-    level->items[xo + 16 * yo] = NULL;
-    robot->x = xd;
-    robot->y = yd;
+    level->moverobot (level, xo + 16 * yo, xd + 16 * yd);
 
     /* return success */
     return 1;
@@ -435,8 +410,7 @@ static int take (Action *action, Robot *robot, Level *level)
 	return 0; /* there is nothing to take */
 
     /* take the item */
-    level->items[xr + 16 * yr] = level->items[xi + 16 * yi];
-    level->items[xi + 16 * yi] = NULL;
+    level->moveitem (level, xi + 16 * yi, xr + 16 * yr);
     return 1;
 }
 
@@ -473,8 +447,7 @@ static int drop (Action *action, Robot *robot, Level *level)
 	return 0; /* can't drop anything there */
 
     /* drop the item */
-    level->items[xi + 16 * yi] = level->items[xr + 16 * yr];
-    level->items[xr + 16 * yr] = NULL;
+    level->moveitem (level, xr + 16 * yr, xi + 16 * yi);
     return 1;
 }
 
@@ -539,7 +512,7 @@ static int shoot (Action *action, Robot *robot, Level *level)
 	/* look at the next square */
 	x += xf;
 	y += yf;
-    } while (x >=0 && x <= 15 && x >= 0 && y <= 11 && ! hit);
+    } while (x >= 0 && x <= 15 && y >= 0 && y <= 11 && ! hit);
 
     /* tell the callling process we did shooting */
     return 1;
@@ -0,0 +1,283 @@
+/*======================================================================
+ * Team Droid: Jam Edition
+ * A programming puzzle game with cute robots.
+ *
+ * Copyright (C) Damian Gareth Walker, 2022.
+ * Catalogue Module.
+ */
+
+/*----------------------------------------------------------------------
+ * Headers
+ */
+
+/* ANSI C headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+/* project-specific headers */
+#include "catalog.h"
+#include "dirindex.h"
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/** @var sortentries The index entries while a list is being sorted. */
+static DirIndexEntry *sortentries;
+
+/** @var sortorder The order a list is being sorted in. */
+static int sortorder;
+
+/*----------------------------------------------------------------------
+ * Level 1 Function Definitions.
+ */
+
+/**
+ * Compare two index entries for sorting, by the current sort order
+ * and then by name and filename.
+ * @param  a A pointer to the record number of the first entry.
+ * @param  b A pointer to the record number of the second entry.
+ * @return   Negative if a comes first, positive if b comes first.
+ */
+static int compare (const void *a, const void *b)
+{
+    DirIndexEntry *ea, /* the first entry */
+	*eb; /* the second entry */
+    int r; /* result of a string comparison */
+
+    /* compare by the sort order */
+    ea = &sortentries[*(int *) a];
+    eb = &sortentries[*(int *) b];
+    if (sortorder == CATALOGUE_LASTPLAYED && ea->saved != eb->saved)
+	return ea->saved > eb->saved ? -1 : 1;
+    if (sortorder == CATALOGUE_SCORE && ea->levelid != eb->levelid)
+	return eb->levelid - ea->levelid;
+    if (sortorder == CATALOGUE_SCORE && ea->total != eb->total)
+	return ea->total - eb->total;
+
+    /* otherwise compare by name */
+    if ((r = strcmp (ea->name, eb->name)))
+	return r;
+    return strcmp (ea->filename, eb->filename);
+}
+
+/**
+ * Find a level pack in a level pack list as it is built.
+ * @param  packs    The level pack list.
+ * @param  filename The filename of the level pack.
+ * @return          The position of the level pack, or -1.
+ */
+static int findlevelpack (Catalogue *packs, char *filename)
+{
+    int p; /* position being checked */
+    for (p = 0; p < packs->count; ++p)
+	if (! strcmp (packs->dirindex->entries[packs->records[p]].filename,
+		      filename))
+	    return p;
+    return -1;
+}
+
+/*----------------------------------------------------------------------
+ * Public Method Function Definitions.
+ */
+
+/**
+ * Destroy the catalogue when it is no longer needed.
+ * @param catalogue The catalogue to destroy.
+ */
+static void destroy (Catalogue *catalogue)
+{
+    if (catalogue) {
+	if (catalogue->records)
+	    free (catalogue->records);
+	if (catalogue->initials)
+	    free (catalogue->initials);
+	if (catalogue->packs)
+	    free (catalogue->packs);
+	free (catalogue);
+    }
+}
+
+/**
+ * Build the list from the directory index, which must still
+ * hold its entries in memory. Games whose level pack is not in
+ * the level pack list are left out.
+ * @param  catalogue The catalogue to build.
+ * @param  sort      The order to sort the list in.
+ * @param  packs     The level pack list, already built from the
+ *                   same index, or NULL for a level pack list.
+ * @return           1 if successful, 0 on failure.
+ */
+static int build (Catalogue *catalogue, int sort, Catalogue *packs)
+{
+    DirIndex *dirindex; /* the directory index */
+    DirIndexEntry *entry; /* pointer to an index entry */
+    int c, /* entry counter */
+	p, /* position in the finished list */
+	packindex = -1; /* position of a game's level pack */
+
+    /* clear the old list */
+    dirindex = catalogue->dirindex;
+    if (catalogue->records)
+	free (catalogue->records);
+    if (catalogue->initials)
+	free (catalogue->initials);
+    if (catalogue->packs)
+	free (catalogue->packs);
+    catalogue->records = NULL;
+    catalogue->initials = NULL;
+    catalogue->packs = NULL;
+    catalogue->count = 0;
+    catalogue->first = -1;
+    catalogue->sort = sort;
+
+    /* reserve memory for the new list */
+    if (dirindex->count && ! dirindex->entries)
+	return 0;
+    if (! (catalogue->records = malloc ((dirindex->count + 1)
+					* sizeof (int))))
+	return 0;
+    if (! (catalogue->initials = malloc (dirindex->count + 1)))
+	return 0;
+    if (packs && ! (catalogue->packs = malloc ((dirindex->count + 1)
+					       * sizeof (int))))
+	return 0;
+
+    /* pick out the entries of the right kind */
+    for (c = 0; c < dirindex->count; ++c)
+	if (dirindex->entries[c].type == catalogue->type)
+	    catalogue->records[catalogue->count++] = c;
+
+    /* sort them, then note their initials and level packs */
+    sortentries = dirindex->entries;
+    sortorder = sort;
+    qsort (catalogue->records, catalogue->count, sizeof (int), compare);
+    for (c = p = 0; c < catalogue->count; ++c) {
+	entry = &dirindex->entries[catalogue->records[c]];
+	if (packs &&
+	    (packindex = findlevelpack (packs, entry->levelpackfile)) == -1)
+	    continue; /* invalid/deleted levelpack file */
+	catalogue->records[p] = catalogue->records[c];
+	catalogue->initials[p] = (char) toupper (entry->name[0]);
+	if (packs)
+	    catalogue->packs[p] = packindex;
+	++p;
+    }
+    catalogue->count = p;
+
+    /* return success */
+    return 1;
+}
+
+/**
+ * Get an entry from the list, reading in its page if necessary.
+ * The entry is only valid until the next page is read.
+ * @param  catalogue The catalogue.
+ * @param  position  The position of the entry in the list.
+ * @return           The entry, or NULL if it cannot be read.
+ */
+static DirIndexEntry *get (Catalogue *catalogue, int position)
+{
+    int first, /* the first position on the page */
+	count; /* the number of entries on the page */
+
+    /* make sure the entry exists */
+    if (position < 0 || position >= catalogue->count)
+	return NULL;
+
+    /* read its page if it is not already in memory */
+    first = position - position % CATALOGUE_PAGESIZE;
+    if (first != catalogue->first) {
+	count = catalogue->count - first;
+	if (count > CATALOGUE_PAGESIZE)
+	    count = CATALOGUE_PAGESIZE;
+	catalogue->first = -1;
+	if (! catalogue->dirindex->read (catalogue->dirindex,
+					 catalogue->records + first,
+					 count, catalogue->page))
+	    return NULL;
+	catalogue->first = first;
+    }
+
+    /* return the entry */
+    return &catalogue->page[position - first];
+}
+
+/**
+ * Find the next entry whose name starts with a letter, going
+ * round to the start of the list if necessary.
+ * @param  catalogue The catalogue to search.
+ * @param  position  The position to search after.
+ * @param  letter    The letter to look for.
+ * @return           The position found, or -1 if there is none.
+ */
+static int jump (Catalogue *catalogue, int position, int letter)
+{
+    int c, /* entry counter */
+	p; /* position being checked */
+    letter = toupper (letter);
+    for (c = 1; c <= catalogue->count; ++c) {
+	p = (position + c) % catalogue->count;
+	if (catalogue->initials[p] == letter)
+	    return p;
+    }
+    return -1;
+}
+
+/**
+ * Find the position of a file in the list.
+ * @param  catalogue The catalogue to search.
+ * @param  filename  The filename to look for.
+ * @return           The position found, or -1 if it is not there.
+ */
+static int locate (Catalogue *catalogue, char *filename)
+{
+    int p; /* position being checked */
+    DirIndexEntry *entry; /* the entry at that position */
+    for (p = 0; p < catalogue->count; ++p)
+	if ((entry = get (catalogue, p)) &&
+	    ! strcmp (entry->filename, filename))
+	    return p;
+    return -1;
+}
+
+/*----------------------------------------------------------------------
+ * Top Level Function Definitions.
+ */
+
+/**
+ * Construct a new catalogue.
+ * @param  dirindex The directory index to list.
+ * @param  type     The kind of file to list, a DirIndexType.
+ * @return          The new catalogue.
+ */
+Catalogue *new_Catalogue (DirIndex *dirindex, int type)
+{
+    Catalogue *catalogue; /* the new catalogue */
+
+    /* reserve memory for the catalogue */
+    if (! (catalogue = malloc (sizeof (Catalogue))))
+	return NULL;
+
+    /* initialise the methods */
+    catalogue->destroy = destroy;
+    catalogue->build = build;
+    catalogue->get = get;
+    catalogue->jump = jump;
+    catalogue->locate = locate;
+
+    /* initialise the attributes */
+    catalogue->dirindex = dirindex;
+    catalogue->type = type;
+    catalogue->sort = CATALOGUE_NAME;
+    catalogue->count = 0;
+    catalogue->records = NULL;
+    catalogue->initials = NULL;
+    catalogue->packs = NULL;
+    catalogue->first = -1;
+
+    /* return the new catalogue */
+    return catalogue;
+}
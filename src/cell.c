@@ -77,52 +77,6 @@ static int yoffset[] = {
     0 /* west */
 };
 
-/*----------------------------------------------------------------------
- * Level 2 Function Definitions.
- */
-
-/**
- * Return the nearest teleport to an X/Y coordinate.
- * @param  level The level to scan.
- * @param  x     The origin x coordinate.
- * @param  y     The origin y coordinate.
- * @return       The destination square.
- */
-static int nearestteleport (Level *level, int x, int y)
-{
-    int c, /* cell counter */
-	dest, /* destination cell */
-	nearest = 0, /* distance to the nearest teleport */
-	dist; /* distance to the scanned cell */
-
-    /* dest defaults to current square */
-    dest = x + 16 * y;
-
-    /* scan through the map for other teleports */
-    for (c = 0; c < 192; ++c) {
-
-	/* skip non-teleports and the start cell */
-	if (c % 16 == x && c / 16 == y)
-	    continue;
-	if (level->cells[c]->type != CELL_TELEPORTER)
-	    continue;
-
-	/* find distance between this teleport and us */
-	dist = abs (c % 16 - x);
-	if (abs (c / 16 - y) > dist)
-	    dist = abs (c / 16 - y);
-
-	/* set destination if it is closest found */
-	if (dist < nearest || nearest == 0) {
-	    dest = c;
-	    nearest = dist;
-	}
-    }
-
-    /* return the destination */
-    return dest;
-}
-
 /*----------------------------------------------------------------------
  * Level 1 Function Definitions.
  */
@@ -160,15 +114,8 @@ static int moverobot (Level *level, int x, int y, int h, int v)
 	return 0; /* cannot move on to some cells */
 
     /* move the robot */
-    level->robots[origin]->x += h;
-    level->robots[origin]->y += v;
     level->robots[origin]->status = ROBOT_CONVEYED;
-    level->robots[dest] = level->robots[origin];
-    level->robots[origin] = NULL;
-
-    /* move any item it is carrying */
-    level->items[dest] = level->items[origin];
-    level->items[origin] = NULL;
+    level->moverobot (level, origin, dest);
 
     /* return 1 to say the robot has moved */
     return 1;
@@ -208,9 +155,8 @@ static int moveitem (Level *level, int x, int y, int h, int v)
 	return 0; /* cannot move on to some cells */
 
     /* move the item */
-    level->items[dest] = level->items[origin];
-    level->items[dest]->status = ITEM_CONVEYED;
-    level->items[origin] = NULL;
+    level->items[origin]->status = ITEM_CONVEYED;
+    level->moveitem (level, origin, dest);
 
     /* return 1 to say the robot has moved */
     return 1;
@@ -381,7 +327,7 @@ static int teleportrobot (Level *level, int x, int y)
 	return 0; /* this robot has just teleported */
 
     /* find the nearest teleport */
-    dest = nearestteleport (level, x, y);
+    dest = level->teleport (level, x + 16 * y);
 
     /* check destination */
     if (dest == x + 16 * y)
@@ -392,13 +338,8 @@ static int teleportrobot (Level *level, int x, int y)
 	return 0; /* there's a robot in the way */
 
     /* teleport robot and item */
-    level->robots[dest] = level->robots[x + 16 * y];
-    level->robots[dest]->x = dest % 16;
-    level->robots[dest]->y = dest / 16;
-    level->robots[dest]->status = ROBOT_TELEPORTED;
-    level->robots[x + 16 * y] = NULL;
-    level->items[dest] = level->items[x + 16 * y];
-    level->items[x + 16 * y] = NULL;
+    level->robots[x + 16 * y]->status = ROBOT_TELEPORTED;
+    level->moverobot (level, x + 16 * y, dest);
     return 1;
 }
 
@@ -420,7 +361,7 @@ static int teleportitem (Level *level, int x, int y)
 	return 0; /* the item has been teleported already */
 
     /* find the nearest teleport */
-    dest = nearestteleport (level, x, y);
+    dest = level->teleport (level, x + 16 * y);
 
     /* check destination */
     if (dest == x + 16 * y)
@@ -431,9 +372,8 @@ static int teleportitem (Level *level, int x, int y)
 	return 0; /* there's a robot in the way */
 
     /* teleport item */
-    level->items[dest] = level->items[x + 16 * y];
-    level->items[dest]->status = ITEM_TELEPORTED;
-    level->items[x + 16 * y] = NULL;
+    level->items[x + 16 * y]->status = ITEM_TELEPORTED;
+    level->moveitem (level, x + 16 * y, dest);
     return 1;
 }
 
@@ -500,7 +440,7 @@ static int deactivateforcefield (Level *level, int x, int y)
 	/* destroy every adjacent forcefield in that direction */
 	while (xc > 0 && xc <= 15 && yc >= 0 && yc <= 11 &&
 	       level->cells[xc + 16 * yc]->type == CELL_FORCEFIELD) {
-	    level->cells[xc + 16 * yc] = get_Cell (CELL_FLOOR);
+	    level->setcell (level, xc + 16 * yc, get_Cell (CELL_FLOOR));
 	    xc += xf;
 	    yc += yf;
 	    changes = 1;
@@ -594,6 +534,10 @@ Cell *get_Cell (int type)
 	break;
     }
 
+    /* note if the cell needs a visit in the effects phase */
+    cells[type - 1]->active = cells[type - 1]->onrobot != noeffect
+	|| cells[type - 1]->onitem != noeffect;
+
     /* return the cell */
     return cells[type - 1];
 }
@@ -68,6 +68,11 @@ static void load (void)
 	if (! readstring (config->player, input))
 	    fatalerror (FATAL_INVALIDINIT, __FILE__, __LINE__);
 
+	/* older files have no playback speed */
+	if (! readint (&config->playback, input) ||
+	    config->playback >= PLAYBACK_LAST)
+	    config->playback = PLAYBACK_NORMAL;
+
         /* close the file */
         fclose (input);
     }
@@ -91,6 +96,7 @@ static void save (void)
 	writestring (config->levelpackfile, output);
 	writestring (config->gamefile, output);
 	writestring (config->player, output);
+	writeint (&config->playback, output);
 
 	/* close the file */
 	fclose (output);
@@ -122,6 +128,7 @@ Config *new_Config (void)
     strcpy (config->levelpackfile, "TDROID.LEV");
     *config->gamefile = '\0';
     strcpy (config->player, "Cyningstan");
+    config->playback = PLAYBACK_NORMAL;
 
     /* return the configuration */
     return config;
@@ -0,0 +1,479 @@
+/*======================================================================
+ * Team Droid: Jam Edition
+ * A programming puzzle game with cute robots.
+ *
+ * Copyright (C) Damian Gareth Walker, 2022.
+ * Directory Index Module.
+ */
+
+/*----------------------------------------------------------------------
+ * Headers
+ */
+
+/* ANSI C headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* compiler specific headers */
+#include <direct.h>
+
+/* project-specific headers */
+#include "dirindex.h"
+#include "game.h"
+#include "levelpak.h"
+#include "fatal.h"
+
+/*----------------------------------------------------------------------
+ * Constants.
+ */
+
+/** @const INDEXFILE The name of the index file. */
+#define INDEXFILE "tdroid.idx"
+
+/** @const HEADERSIZE The size of the index file header and count. */
+#define HEADERSIZE 10
+
+/** @const RECORDSIZE The size of an entry in the index file. */
+#define RECORDSIZE 56
+
+/** @const GROWBY The number of entries to add when the list is full. */
+#define GROWBY 16
+
+/**
+ * @const MAXENTRIES The most entries the index holds, so that the
+ * entries and the index file records each fit in one allocation.
+ */
+#define MAXENTRIES 1024
+
+/*----------------------------------------------------------------------
+ * Level 3 Function Definitions.
+ */
+
+/**
+ * Pack an unsigned number into bytes, least significant first.
+ * @param bytes The bytes to pack into.
+ * @param value The number to pack.
+ * @param size  The number of bytes.
+ */
+static void packnumber (unsigned char *bytes, unsigned long value,
+			int size)
+{
+    int c; /* byte counter */
+    for (c = 0; c < size; ++c)
+	bytes[c] = (unsigned char) ((value >> (8 * c)) & 0xff);
+}
+
+/**
+ * Unpack an unsigned number from bytes, least significant first.
+ * @param  bytes The bytes to unpack.
+ * @param  size  The number of bytes.
+ * @return       The number.
+ */
+static unsigned long unpacknumber (unsigned char *bytes, int size)
+{
+    unsigned long value = 0; /* the number */
+    while (size--)
+	value = (value << 8) | bytes[size];
+    return value;
+}
+
+/*----------------------------------------------------------------------
+ * Level 2 Function Definitions.
+ */
+
+/**
+ * Pack an entry into a record for the index file.
+ * @param entry  The entry to pack.
+ * @param record The record to pack into, already cleared.
+ */
+static void packentry (DirIndexEntry *entry, unsigned char *record)
+{
+    strncpy ((char *) record, entry->filename, 12);
+    record[13] = (unsigned char) entry->type;
+    packnumber (record + 14, entry->date, 2);
+    packnumber (record + 16, entry->time, 2);
+    packnumber (record + 18, (unsigned long) entry->size, 4);
+    strncpy ((char *) record + 22, entry->name, 13);
+    strncpy ((char *) record + 36, entry->levelpackfile, 12);
+    record[49] = (unsigned char) entry->levelid;
+    packnumber (record + 50, (unsigned long) entry->total, 2);
+    packnumber (record + 52, (unsigned long) entry->saved, 4);
+}
+
+/**
+ * Unpack an entry from a record in the index file.
+ * @param entry  The entry to unpack into.
+ * @param record The record to unpack.
+ */
+static void unpackentry (DirIndexEntry *entry, unsigned char *record)
+{
+    strncpy (entry->filename, (char *) record, 12);
+    entry->filename[12] = '\0';
+    entry->type = record[13];
+    entry->date = (unsigned int) unpacknumber (record + 14, 2);
+    entry->time = (unsigned int) unpacknumber (record + 16, 2);
+    entry->size = (long) unpacknumber (record + 18, 4);
+    strncpy (entry->name, (char *) record + 22, 13);
+    entry->name[13] = '\0';
+    strncpy (entry->levelpackfile, (char *) record + 36, 12);
+    entry->levelpackfile[12] = '\0';
+    entry->levelid = record[49];
+    entry->total = (int) unpacknumber (record + 50, 2);
+    entry->saved = (time_t) unpacknumber (record + 52, 4);
+}
+
+/*----------------------------------------------------------------------
+ * Level 1 Function Definitions.
+ */
+
+/**
+ * Find out what kind of file a directory entry is.
+ * @param  filename The filename.
+ * @return          The DirIndexType, or -1 if it is neither.
+ */
+static int filetype (char *filename)
+{
+    char *ext; /* pointer to filename extension */
+    if (! (ext = strchr (filename, '.')))
+	return -1;
+    if (! strcmp (ext, ".lev") || ! strcmp (ext, ".LEV"))
+	return DIRINDEX_LEVELPACK;
+    if (! strcmp (ext, ".gam") || ! strcmp (ext, ".GAM"))
+	return DIRINDEX_GAME;
+    return -1;
+}
+
+/**
+ * Read the summary of a file into an index entry.
+ * @param  entry     The entry, with its filename and type set.
+ * @param  levelpack A level pack to read summaries with.
+ * @param  game      A game to read summaries with.
+ * @return           1 if successful, 0 if the file is invalid.
+ */
+static int readsummary (DirIndexEntry *entry, LevelPack *levelpack,
+			Game *game)
+{
+    /* summarise a level pack */
+    if (entry->type == DIRINDEX_LEVELPACK) {
+	strcpy (levelpack->filename, entry->filename);
+	if (! levelpack->load (levelpack, 1))
+	    return 0;
+	strcpy (entry->name, levelpack->name);
+	*entry->levelpackfile = '\0';
+	entry->levelid = entry->total = 0;
+	entry->saved = 0;
+	return 1;
+    }
+
+    /* summarise a game */
+    strcpy (game->filename, entry->filename);
+    if (! game->load (game, 1))
+	return 0;
+    strcpy (entry->name, game->player);
+    strcpy (entry->levelpackfile, game->levelpackfile);
+    entry->levelid = game->levelid;
+    entry->total = game->total;
+    entry->saved = game->saved;
+    return 1;
+}
+
+/**
+ * Read the index file.
+ * @param dirindex The index to read into.
+ */
+static void readindex (DirIndex *dirindex)
+{
+    FILE *input; /* the index file */
+    char header[8]; /* header read from file */
+    unsigned char count[2], /* the count as read from the file */
+	*records; /* the records as read from the file */
+    int c; /* entry counter */
+
+    /* open the index file and read the header */
+    dirindex->count = 0;
+    if (! (input = fopen (INDEXFILE, "rb")))
+	return;
+    if (! fread (header, 8, 1, input) ||
+	strcmp (header, "TDR100I") ||
+	! fread (count, 2, 1, input)) {
+	fclose (input);
+	return;
+    }
+
+    /* an empty index is still a valid one, an oversized one is not */
+    if ((c = (int) unpacknumber (count, 2)) > MAXENTRIES) {
+	fclose (input);
+	return;
+    }
+    if (! c) {
+	fclose (input);
+	dirindex->cached = 1;
+	return;
+    }
+
+    /* read all the records in one go */
+    if (! (records = malloc ((size_t) c * RECORDSIZE))) {
+	fclose (input);
+	return;
+    }
+    if (! fread (records, (size_t) c * RECORDSIZE, 1, input) ||
+	! (dirindex->entries = malloc ((size_t) c
+				       * sizeof (DirIndexEntry)))) {
+	free (records);
+	fclose (input);
+	return;
+    }
+    fclose (input);
+    dirindex->count = c;
+    dirindex->cached = 1;
+
+    /* unpack the records */
+    for (c = 0; c < dirindex->count; ++c)
+	unpackentry (&dirindex->entries[c], records + (size_t) c * RECORDSIZE);
+    free (records);
+}
+
+/**
+ * Write the index file.
+ * @param  dirindex The index to write.
+ * @return          1 if successful, 0 on failure.
+ */
+static int writeindex (DirIndex *dirindex)
+{
+    FILE *output; /* the index file */
+    unsigned char count[2], /* the count to write to the file */
+	*records; /* the records to write to the file */
+    int c, /* entry counter */
+	r = 1; /* return value */
+
+    /* pack the records */
+    if (! (records = calloc (dirindex->count + 1, RECORDSIZE)))
+	return 0;
+    for (c = 0; c < dirindex->count; ++c)
+	packentry (&dirindex->entries[c], records + (size_t) c * RECORDSIZE);
+
+    /* write the header, the count and the records */
+    if (! (output = fopen (INDEXFILE, "wb"))) {
+	free (records);
+	return 0;
+    }
+    packnumber (count, dirindex->count, 2);
+    r = r && fwrite ("TDR100I", 8, 1, output);
+    r = r && fwrite (count, 2, 1, output);
+    if (dirindex->count)
+	r = r && fwrite (records, (size_t) dirindex->count * RECORDSIZE, 1,
+			 output);
+    fclose (output);
+    free (records);
+    return r;
+}
+
+/*----------------------------------------------------------------------
+ * Public Method Function Definitions.
+ */
+
+/**
+ * Destroy the index when it is no longer needed.
+ * @param dirindex The index to destroy.
+ */
+static void destroy (DirIndex *dirindex)
+{
+    if (dirindex) {
+	if (dirindex->entries)
+	    free (dirindex->entries);
+	free (dirindex);
+    }
+}
+
+/**
+ * Bring the index up to date with the directory. Only files that
+ * are new or whose date, time or size have changed are opened,
+ * and the index file is only rewritten if something changed.
+ * Files beyond the first MAXENTRIES are left out.
+ * @param  dirindex The index to refresh.
+ * @return          1 if successful, 0 if the directory is unreadable.
+ */
+static int refresh (DirIndex *dirindex)
+{
+    DIR *dir; /* directory handle */
+    struct dirent *direntry; /* a directory entry */
+    DirIndexEntry *old, /* the entries before the refresh */
+	*entries = NULL, /* the entries after the refresh */
+	*entry, /* the entry being filled in */
+	*match; /* the old entry for the same file */
+    int oldcount, /* the number of entries before the refresh */
+	count = 0, /* the number of entries after the refresh */
+	size = 0, /* the number of entries there is room for */
+	type, /* the type of a directory entry */
+	changed = 0, /* 1 if anything has changed */
+	c; /* old entry counter */
+    LevelPack *levelpack = NULL; /* level pack for reading summaries */
+    Game *game = NULL; /* game for reading summaries */
+
+    /* read the index file if the index is empty */
+    if (! dirindex->entries)
+	readindex (dirindex);
+    old = dirindex->entries;
+    oldcount = dirindex->count;
+
+    /* attempt to open the directory */
+    if (! (dir = opendir (".")))
+	return 0;
+
+    /* read each entry and see if it is a level pack or game */
+    while ((direntry = readdir (dir))) {
+	if ((type = filetype (direntry->d_name)) == -1)
+	    continue;
+	if (count == MAXENTRIES)
+	    break;
+
+	/* make room for another entry */
+	if (count == size) {
+	    size += GROWBY;
+	    if (! (entry = realloc (entries, (size_t) size
+				    * sizeof (DirIndexEntry))))
+		fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+	    entries = entry;
+	}
+	entry = &entries[count];
+
+	/* look for the file in the old index, usually in the same place */
+	match = NULL;
+	if (count < oldcount && ! strcmp (old[count].filename,
+					  direntry->d_name))
+	    match = &old[count];
+	for (c = 0; ! match && c < oldcount; ++c)
+	    if (! strcmp (old[c].filename, direntry->d_name))
+		match = &old[c];
+
+	/* reuse the old entry if the file has not changed */
+	if (match &&
+	    match->date == direntry->d_date &&
+	    match->time == direntry->d_time &&
+	    match->size == (long) direntry->d_size) {
+	    if (count >= oldcount || match != &old[count])
+		changed = 1; /* the file's record number has changed */
+	    *entry = *match;
+	    ++count;
+	    continue;
+	}
+
+	/* otherwise read the summary from the file itself */
+	if (! levelpack && ! (levelpack = new_LevelPack ()))
+	    fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+	if (! game && ! (game = new_Game ()))
+	    fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+	strcpy (entry->filename, direntry->d_name);
+	entry->type = type;
+	entry->date = direntry->d_date;
+	entry->time = direntry->d_time;
+	entry->size = (long) direntry->d_size;
+	if (readsummary (entry, levelpack, game)) {
+	    changed = 1;
+	    ++count;
+	}
+    }
+    closedir (dir);
+
+    /* tidy up the objects used for reading summaries */
+    if (levelpack)
+	levelpack->destroy (levelpack);
+    if (game)
+	game->destroy (game);
+
+    /* replace the old entries with the new */
+    if (old)
+	free (old);
+    dirindex->entries = entries;
+    dirindex->count = count;
+
+    /* rewrite the index file, a cache that may fail, if it changed */
+    if (changed || count != oldcount)
+	dirindex->cached = writeindex (dirindex);
+    return 1;
+}
+
+/**
+ * Free the entries held in memory if the index file has them all,
+ * so that they can be read back a few at a time.
+ * @param dirindex The index to release.
+ */
+static void release (DirIndex *dirindex)
+{
+    if (dirindex->cached && dirindex->entries) {
+	free (dirindex->entries);
+	dirindex->entries = NULL;
+    }
+}
+
+/**
+ * Read some entries, from memory if they are still held there or
+ * from the index file otherwise.
+ * @param  dirindex The index to read from.
+ * @param  records  The record number of each entry to read.
+ * @param  count    The number of entries to read.
+ * @param  entries  The entries to read into.
+ * @return          1 if successful, 0 on failure.
+ */
+static int read (DirIndex *dirindex, int *records, int count,
+		 DirIndexEntry *entries)
+{
+    FILE *input; /* the index file */
+    unsigned char record[RECORDSIZE]; /* a record read from the file */
+    int c, /* entry counter */
+	r = 1; /* return value */
+
+    /* copy the entries if they are in memory */
+    if (dirindex->entries) {
+	for (c = 0; c < count; ++c)
+	    entries[c] = dirindex->entries[records[c]];
+	return 1;
+    }
+
+    /* otherwise read each one from its place in the index file */
+    if (! (input = fopen (INDEXFILE, "rb")))
+	return 0;
+    for (c = 0; r && c < count; ++c) {
+	r = r &&
+	    ! fseek (input, HEADERSIZE + (long) records[c] * RECORDSIZE,
+		     SEEK_SET) &&
+	    fread (record, RECORDSIZE, 1, input);
+	if (r)
+	    unpackentry (&entries[c], record);
+    }
+    fclose (input);
+    return r;
+}
+
+/*----------------------------------------------------------------------
+ * Top Level Function Definitions.
+ */
+
+/**
+ * Construct a new directory index.
+ * @return The new index.
+ */
+DirIndex *new_DirIndex (void)
+{
+    DirIndex *dirindex; /* the new index */
+
+    /* reserve memory for the index */
+    if (! (dirindex = malloc (sizeof (DirIndex))))
+	return NULL;
+
+    /* initialise the methods */
+    dirindex->destroy = destroy;
+    dirindex->refresh = refresh;
+    dirindex->release = release;
+    dirindex->read = read;
+
+    /* initialise the attributes */
+    dirindex->count = 0;
+    dirindex->entries = NULL;
+    dirindex->cached = 0;
+
+    /* return the new index */
+    return dirindex;
+}
@@ -27,25 +27,62 @@
 #include "game.h"
 #include "controls.h"
 #include "timer.h"
+#include "profile.h"
 #include "cgalib.h"
 #include "speaker.h"
+#include "assets.h"
 
+/*----------------------------------------------------------------------
+ * Constants.
+ */
+
+/** @const TILEWIDTH The width of a dirty tile: one byte of CGA memory. */
+#define TILEWIDTH 4
+
+/** @const TILEHEIGHT The height of a dirty tile in pixel rows. */
+#define TILEHEIGHT 4
+
+/** @const TILECOLS The number of dirty tiles across the screen. */
+#define TILECOLS (320 / TILEWIDTH)
+
+/** @const TILEROWS The number of dirty tiles down the screen. */
+#define TILEROWS (200 / TILEHEIGHT)
+
+/** @const STALE A shadow value that matches no level map square. */
+#define STALE 0xffff
+
+/** @const CACHESIZE The most composited map squares kept in memory. */
+#define CACHESIZE 48
+
+/** @const CACHEBUCKETS The number of hash chains in the square cache. */
+#define CACHEBUCKETS 32
 
 /*----------------------------------------------------------------------
  * Data Definitions.
  */
 
 /**
- * @struct displaylist
- * A linked list containing coordinates to be updated.
+ * @struct cachedsquare
+ * A map square with its tile and occupant composited together.
  */
-typedef struct displaylist DisplayList;
-struct displaylist {
-    int x, /* x coordinate to update */
-	y, /* y coordinate to update */
-	w, /* width to update */
-	h; /* height to update */
-    DisplayList *next; /* next entry in display list */
+typedef struct cachedsquare CachedSquare;
+struct cachedsquare {
+    unsigned int contents, /* the square contents, or STALE if unused */
+	lastused; /* the cache clock when the square was last drawn */
+    int next; /* next entry in the same hash chain, or -1 */
+    Bitmap *bitmap; /* the composited bitmap */
+};
+
+/**
+ * @struct savedarea
+ * The part of the screen behind a phaser beam, kept to put back.
+ */
+typedef struct savedarea SavedArea;
+struct savedarea {
+    int x, /* the screen x coordinate, a multiple of 4 */
+	y, /* the screen y coordinate */
+	width; /* the width to put back, 16 or 20 pixels */
+    Bitmap *bitmap; /* the saved pixels, 20 by 16 */
 };
 
 /**
@@ -61,8 +98,14 @@ typedef enum {
 /** @var display The display object */
 static Display *display = NULL;
 
-/** @var displaylist A list of areas to update. */
-static DisplayList *displaylist = NULL;
+/** @var dirty 1 for each tile of the screen waiting to be updated. */
+static char dirty[TILEROWS][TILECOLS];
+
+/** @var dirtyfirst The first dirty tile in each row. */
+static int dirtyfirst[TILEROWS];
+
+/** @var dirtylast One past the last dirty tile in each row. */
+static int dirtylast[TILEROWS];
 
 /** @var screen is the CGALIB screen data. */
 static Screen *screen;
@@ -130,17 +173,23 @@ static Bitmap *ramtiles[5];
 /** @var dialoguebox The dialog box bitmap. */
 static Bitmap *dialoguebox;
 
+/** @var customdialogue The dialogue box with its message. */
+static Bitmap *customdialogue;
+
 /** @var progressbar Sections of the action progress bar. */
 static Bitmap *progressbar[4];
 
 /** @var font is the font in standard colours. */
 static Font *font;
 
-/** @var highfont is the font in highlighted colours. */
-static Font *highfont;
+/** @var assetoffsets The offset of each section of the asset file. */
+static long assetoffsets[ASSETS_LAST];
 
-/** @var lowfont is the font in lowlighted colours. */
-static Font *lowfont;
+/** @var assetsizes The size of each section of the asset file. */
+static unsigned int assetsizes[ASSETS_LAST];
+
+/** @var assetdata The sections in memory, which the bitmaps use. */
+static char *assetdata[ASSETS_LAST];
 
 /** @var soundenabled 1 if sound enabled, 0 if not. */
 static int soundenabled;
@@ -164,12 +213,408 @@ static Game *game = NULL;
  */
 static int wholemap = 0;
 
+/**
+ * @var shadow
+ * What was last drawn on each level map square, as encoded by
+ * squarecontents(), or STALE if the screen no longer shows it.
+ */
+static unsigned int shadow[192];
+
+/** @var squarecache Composited map squares, reused as they are drawn. */
+static CachedSquare squarecache[CACHESIZE];
+
+/** @var cachechains The first square cache entry in each hash chain. */
+static int cachechains[CACHEBUCKETS];
+
+/** @var cacheclock Counts square cache lookups, for eviction. */
+static unsigned int cacheclock = 0;
+
+/** @var beamunders The screen behind each phaser beam shown. */
+static SavedArea beamunders[DISPLAY_MAXBEAMS];
+
+/** @var captureenabled 1 if action playback is recorded, 0 if not. */
+static int captureenabled;
+
+/** @var capture The animated GIF being recorded, or NULL if none. */
+static Gif *capture = NULL;
+
+/** @var captureoutput The file the animated GIF is written to. */
+static FILE *captureoutput;
+
+/** @var captureframe The screen last captured, not yet written. */
+static Bitmap *captureframe;
+
+/** @var captureclock The time the screen was last captured. */
+static clock_t captureclock;
+
 /*----------------------------------------------------------------------
  * Service Level Private Functions.
  */
 
+#ifdef DEBUG
+
+/**
+ * Put a bitmap on the screen, timing the blit.
+ * @param dst  The screen.
+ * @param src  The bitmap to put.
+ * @param x    The x coordinate on the screen.
+ * @param y    The y coordinate on the screen.
+ * @param draw The drawing mode.
+ */
+static void profiledput (Screen *dst, Bitmap *src, int x, int y,
+			 DrawMode draw)
+{
+    PROFILE_START (PROFILE_BLIT);
+    scr_put (dst, src, x, y, draw);
+    PROFILE_STOP (PROFILE_BLIT);
+}
+
+/**
+ * Put part of a bitmap on the screen, timing the blit.
+ * @param dst  The screen.
+ * @param src  The bitmap to put.
+ * @param xd   The x coordinate on the screen.
+ * @param yd   The y coordinate on the screen.
+ * @param xs   The x coordinate on the bitmap.
+ * @param ys   The y coordinate on the bitmap.
+ * @param w    The width of the area to put.
+ * @param h    The height of the area to put.
+ * @param draw The drawing mode.
+ */
+static void profiledputpart (Screen *dst, Bitmap *src, int xd, int yd,
+			     int xs, int ys, int w, int h, DrawMode draw)
+{
+    PROFILE_START (PROFILE_BLIT);
+    scr_putpart (dst, src, xd, yd, xs, ys, w, h, draw);
+    PROFILE_STOP (PROFILE_BLIT);
+}
+
+/**
+ * Put a masked sprite on the screen, timing the blit.
+ * @param dst  The screen.
+ * @param src  The sprite to put.
+ * @param mask The mask for the sprite.
+ * @param x    The x coordinate on the screen.
+ * @param y    The y coordinate on the screen.
+ */
+static void profiledputmasked (Screen *dst, Bitmap *src, Bitmap *mask,
+			       int x, int y)
+{
+    PROFILE_START (PROFILE_BLIT);
+    scr_putmasked (dst, src, mask, x, y);
+    PROFILE_STOP (PROFILE_BLIT);
+}
+
+/* debug builds time every blit to the screen */
+#define scr_put profiledput
+#define scr_putpart profiledputpart
+#define scr_putmasked profiledputmasked
+
+#endif
+
+/**
+ * Get a little-endian number from the asset data.
+ * @param  data  The position of the number in the asset data.
+ * @param  bytes The number of bytes the number takes up.
+ * @return       The number.
+ */
+static unsigned long assetnumber (char *data, int bytes)
+{
+    unsigned long value = 0; /* the value of the number */
+    while (bytes--)
+	value = (value << 8) | (unsigned char) data[bytes];
+    return value;
+}
+
+/**
+ * Make a bitmap from the asset data where it lies, moving on past it.
+ * @param  data A pointer to the position in the asset data.
+ * @return      The bitmap.
+ */
+static Bitmap *viewbitmap (char **data)
+{
+    Bitmap *bitmap; /* the bitmap to return */
+    int w, /* width of the bitmap */
+	h; /* height of the bitmap */
+    w = (int) assetnumber (*data, 2);
+    h = (int) assetnumber (*data + 2, 2);
+    if (! (bitmap = bit_view (w, h, *data + 4)))
+	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+    *data += 4 + w / 4 * h;
+    return bitmap;
+}
+
+/**
+ * Destroy some bitmaps, leaving their pointers NULL.
+ * @param bitmaps The bitmap pointers.
+ * @param count   The number of bitmaps.
+ */
+static void destroybitmaps (Bitmap **bitmaps, int count)
+{
+    int c; /* bitmap counter */
+    for (c = 0; c < count; ++c)
+	if (bitmaps[c]) {
+	    bit_destroy (bitmaps[c]);
+	    bitmaps[c] = NULL;
+	}
+}
+
+/**
+ * Read a section of the asset file into memory, seeking straight to
+ * it by way of the table of contents.
+ * @param  id The section to read.
+ * @return    The section data.
+ */
+static char *readsection (int id)
+{
+    FILE *input; /* input file */
+    if (! (assetdata[id] = malloc (assetsizes[id])))
+	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+    if (! (input = fopen (ASSETS_FILENAME, "rb")))
+	fatalerror (FATAL_NODATA, __FILE__, __LINE__);
+    if (fseek (input, assetoffsets[id], SEEK_SET))
+	fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
+    if (! fread (assetdata[id], assetsizes[id], 1, input))
+	fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
+    fclose (input);
+    return assetdata[id];
+}
+
+/**
+ * Make sure a section of the asset file was used up exactly.
+ * @param data The position reached in the section.
+ * @param id   The section.
+ */
+static void checksection (char *data, int id)
+{
+    if (data != assetdata[id] + assetsizes[id])
+	fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
+}
+
+/**
+ * Free a section of the asset file once nothing is using it.
+ * @param id The section to free.
+ */
+static void freesection (int id)
+{
+    if (assetdata[id])
+	free (assetdata[id]);
+    assetdata[id] = NULL;
+}
+
+/**
+ * Load the title screen if it is not already in memory.
+ */
+static void loadtitle (void)
+{
+    char *data; /* position in the asset data */
+    if (title)
+	return;
+    data = readsection (ASSETS_TITLE);
+    title = viewbitmap (&data);
+    checksection (data, ASSETS_TITLE);
+}
+
+/**
+ * Release the title screen when it is no longer needed.
+ */
+static void releasetitle (void)
+{
+    destroybitmaps (&title, 1);
+    freesection (ASSETS_TITLE);
+}
+
+/**
+ * Load the gameplay graphics if they are not already in memory.
+ */
+static void loadgraphics (void)
+{
+    char *data; /* position in the asset data */
+    int c, /* general counter */
+	f; /* robot facing counter */
+
+    /* the border and panel graphics */
+    if (border)
+	return;
+    data = readsection (ASSETS_GRAPHICS);
+    border = viewbitmap (&data);
+    for (c = 0; c < 3; ++c)
+	panels[c] = viewbitmap (&data);
+
+    /* the robots */
+    for (c = 0; c < 7; ++c)
+	for (f = 0; f < 4; ++f) {
+	    robots[c][f] = viewbitmap (&data);
+	    robotmasks[c][f] = viewbitmap (&data);
+	}
+
+    /* the items */
+    for (c = 0; c < 6; ++c) {
+	items[c] = viewbitmap (&data);
+	itemmasks[c] = viewbitmap (&data);
+    }
+
+    /* various one-off sprites */
+    cursor = viewbitmap (&data);
+    cursormask = viewbitmap (&data);
+    blast = viewbitmap (&data);
+    blastmask = viewbitmap (&data);
+    bump = viewbitmap (&data);
+    bumpmask = viewbitmap (&data);
+
+    /* the map cell tiles */
+    for (c = 0; c < 12; ++c)
+	maptiles[c] = viewbitmap (&data);
+
+    /* the action tiles */
+    for (c = 0; c < 12; ++c)
+	actiontiles[c] = viewbitmap (&data);
+
+    /* the phaser sprites, shifted now as they slide during playback */
+    for (c = 0; c < 2; ++c) {
+	phaserbeams[c] = viewbitmap (&data);
+	phasermasks[c] = viewbitmap (&data);
+	if (! bit_preshift (phaserbeams[c], phasermasks[c]))
+	    fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+    }
+
+    /* the RAM/ROM/Inventory filler tiles */
+    for (c = 0; c < 5; ++c)
+	ramtiles[c] = viewbitmap (&data);
+
+    /* the progress bar */
+    for (c = 0; c < 4; ++c)
+	progressbar[c] = viewbitmap (&data);
+
+    /* the dialog box border */
+    dialoguebox = viewbitmap (&data);
+    checksection (data, ASSETS_GRAPHICS);
+    if (! (customdialogue = bit_copy (dialoguebox)))
+	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+}
+
+/**
+ * Release the gameplay graphics.
+ */
+static void releasegraphics (void)
+{
+    destroybitmaps (&border, 1);
+    destroybitmaps (panels, PANEL_LAST);
+    destroybitmaps (&robots[0][0], 7 * 4);
+    destroybitmaps (&robotmasks[0][0], 7 * 4);
+    destroybitmaps (items, 6);
+    destroybitmaps (itemmasks, 6);
+    destroybitmaps (&cursor, 1);
+    destroybitmaps (&cursormask, 1);
+    destroybitmaps (&blast, 1);
+    destroybitmaps (&blastmask, 1);
+    destroybitmaps (&bump, 1);
+    destroybitmaps (&bumpmask, 1);
+    destroybitmaps (maptiles, 12);
+    destroybitmaps (actiontiles, 12);
+    destroybitmaps (phaserbeams, 2);
+    destroybitmaps (phasermasks, 2);
+    destroybitmaps (ramtiles, 5);
+    destroybitmaps (progressbar, 4);
+    destroybitmaps (&dialoguebox, 1);
+    destroybitmaps (&customdialogue, 1);
+    freesection (ASSETS_GRAPHICS);
+}
+
+/**
+ * Load the font if it is not already in memory, along with the
+ * coloured copies the screens print with.
+ */
+static void loadfont (void)
+{
+    char *data; /* position in the asset data */
+    if (font)
+	return;
+    data = readsection (ASSETS_FONT);
+    if (! (font = fnt_view (data[0], data[1], data + 2)))
+	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+    checksection (data + 2 + 8 * (data[1] - data[0] + 1), ASSETS_FONT);
+    if (! fnt_precolour (font, 1, 0) || ! fnt_precolour (font, 3, 2))
+	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+}
+
+/**
+ * Release the font.
+ */
+static void releasefont (void)
+{
+    if (font)
+	fnt_destroy (font);
+    font = NULL;
+    freesection (ASSETS_FONT);
+}
+
+/**
+ * Load the sound effects if they are not already in memory. The
+ * effects keep their own copy of the data, so it is freed at once.
+ */
+static void loadnoises (void)
+{
+    char *data; /* position in the asset data */
+    int c; /* effect counter */
+    if (noises[0])
+	return;
+    data = readsection (ASSETS_SOUND);
+    checksection (data + 9 * 6, ASSETS_SOUND);
+    for (c = 0; c < 9; ++c, data += 6) {
+	if (! (noises[c] = new_Effect ()))
+	    fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+	noises[c]->pattern = (unsigned char) data[0];
+	noises[c]->repetitions = (unsigned char) data[1];
+	noises[c]->low = (unsigned char) data[2];
+	noises[c]->high = (unsigned char) data[3];
+	noises[c]->duration = (unsigned char) data[4];
+	noises[c]->pause = (unsigned char) data[5];
+    }
+    freesection (ASSETS_SOUND);
+}
+
+/**
+ * Release the sound effects.
+ */
+static void releasenoises (void)
+{
+    int c; /* effect counter */
+    for (c = 0; c < 9; ++c)
+	if (noises[c]) {
+	    noises[c]->destroy (noises[c]);
+	    noises[c] = NULL;
+	}
+}
+
+/**
+ * Choose the colours for text printed on the screen.
+ * @param ink   The ink colour.
+ * @param paper The paper colour.
+ */
+static void screenfont (int ink, int paper)
+{
+    loadfont ();
+    scr_font (screen, font);
+    scr_ink (screen, ink);
+    scr_paper (screen, paper);
+}
+
+/**
+ * Choose the colours for text printed on the screen buffer.
+ * @param ink   The ink colour.
+ * @param paper The paper colour.
+ */
+static void bufferfont (int ink, int paper)
+{
+    loadfont ();
+    bit_font (scrbuf, font);
+    bit_ink (scrbuf, ink);
+    bit_paper (scrbuf, paper);
+}
+
 /**
- * Add a screen area to the display list (areas to be updated).
+ * Mark a screen area as needing to be updated.
  * @param x The x coordinate of the area.
  * @param y The y coordinate of the area.
  * @param w The width of the area.
@@ -177,21 +622,67 @@ static int wholemap = 0;
  */
 static void queueupdate (int x, int y, int w, int h)
 {
-    DisplayList *entry; /* new entry for display list */
-
-    /* reserve memory for new display list entry */
-    if (! (entry = malloc (sizeof (DisplayList))))
-	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
-
-    /* fill in the display list entry */
-    entry->x = x;
-    entry->y = y;
-    entry->w = w;
-    entry->h = h;
+    int left, /* first tile column of the area */
+	right, /* one past the last tile column */
+	top, /* first tile row of the area */
+	bottom, /* one past the last tile row */
+	r; /* row counter */
+
+    /* work out which tiles the area covers */
+    left = x / TILEWIDTH;
+    right = (x + w + TILEWIDTH - 1) / TILEWIDTH;
+    top = y / TILEHEIGHT;
+    bottom = (y + h + TILEHEIGHT - 1) / TILEHEIGHT;
+    if (right > TILECOLS)
+	right = TILECOLS;
+    if (bottom > TILEROWS)
+	bottom = TILEROWS;
+
+    /* mark the tiles and widen each row's dirty range */
+    for (r = top; r < bottom; ++r) {
+	memset (&dirty[r][left], 1, right - left);
+	if (dirtyfirst[r] >= dirtylast[r]) {
+	    dirtyfirst[r] = left;
+	    dirtylast[r] = right;
+	} else {
+	    if (left < dirtyfirst[r])
+		dirtyfirst[r] = left;
+	    if (right > dirtylast[r])
+		dirtylast[r] = right;
+	}
+    }
+}
 
-    /* add to the display list */
-    entry->next = displaylist;
-    displaylist = entry;
+/**
+ * Update a rectangle of dirty tiles, starting from a horizontal span
+ * and extending it down as far as the rows below are dirty across
+ * the whole span. The tiles updated are marked clean.
+ * @param row   The tile row the span is on.
+ * @param left  The first tile column of the span.
+ * @param right One past the last tile column of the span.
+ */
+static void updatespan (int row, int left, int right)
+{
+    int bottom, /* one past the last tile row of the rectangle */
+	r; /* row counter */
+
+    /* extend the span down while the rows below are dirty */
+    for (bottom = row + 1; bottom < TILEROWS; ++bottom)
+	if (dirtyfirst[bottom] > left ||
+	    dirtylast[bottom] < right ||
+	    memchr (&dirty[bottom][left], 0, right - left))
+	    break;
+
+    /* mark the rectangle clean */
+    for (r = row; r < bottom; ++r)
+	memset (&dirty[r][left], 0, right - left);
+
+    /* copy it to the screen */
+    scr_putpart (screen, scrbuf,
+		 TILEWIDTH * left, TILEHEIGHT * row,
+		 TILEWIDTH * left, TILEHEIGHT * row,
+		 TILEWIDTH * (right - left), TILEHEIGHT * (bottom - row),
+		 DRAW_PSET);
 }
 
 /**
@@ -210,8 +701,7 @@ static void edittext (char *etext, int length, int x, int y)
     sprintf (buf, "%-*.*s", length, length, etext);
     bit_ink (scrbuf, 0);
     bit_box (scrbuf, x, y, 4 * length, 8);
-    bit_ink (scrbuf, 3);
-    bit_font (scrbuf, highfont);
+    bufferfont (3, 2);
     bit_print (scrbuf, x, y, buf);
     queueupdate (x, y, 4 * length, 8);
     display->update ();
@@ -246,139 +736,196 @@ static void edittext (char *etext, int length, int x, int y)
     } while (ascii != 13);
 
     /* clean up and wait for enter release */
-    bit_ink (scrbuf, 3);
-    bit_font (scrbuf, font);
+    bufferfont (3, 0);
     bit_print (scrbuf, x, y, buf);
     display->update ();
     while (controls->fire ());
 }
 
-/*----------------------------------------------------------------------
- * Level 1 Private Function Definitions.
+/**
+ * Reset the square cache, leaving any bitmaps for reuse.
  */
+static void clearsquarecache (void)
+{
+    int c; /* general counter */
+    for (c = 0; c < CACHESIZE; ++c) {
+	squarecache[c].contents = STALE;
+	squarecache[c].lastused = 0;
+	squarecache[c].next = -1;
+    }
+    for (c = 0; c < CACHEBUCKETS; ++c)
+	cachechains[c] = -1;
+    cacheclock = 0;
+}
 
 /**
- * Load the graphical assets.
+ * Choose a square cache entry to reuse: an unused one if there is
+ * one, or else the one least recently drawn. It is taken out of its
+ * hash chain.
+ * @return The index of the entry.
  */
-static void loadassets (void)
+static int evictsquare (void)
 {
-    FILE *input; /* input file */
-    char header[8]; /* the input file header */
-    Bitmap *logo; /* the Cyningstan logo */
-    time_t start; /* time the Cyningstan logo was displayed */
-    int c, /* general counter */
-	f; /* robot facing counter */
-
-    /* open input file */
-    if (! (input = fopen ("tdroid.dat", "rb")))
-	fatalerror (FATAL_NODATA, __FILE__, __LINE__);
-    else if (! fread (header, 8, 1, input))
-	fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
-    else if (strcmp (header, "TDR100D"))
-	fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
-
-    /* load and display the Cyningstan logo */
-    start = time (NULL);
-    if (! (logo = bit_read (input)))
-	fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
-    scr_put (screen, logo, 96, 92, DRAW_PSET);
-    bit_destroy (logo);
-
-    /* load the title screen graphic */
-    if (! (title = bit_read (input)))
-	fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
+    int c, /* entry counter */
+	oldest = 0, /* the least recently used entry */
+	*link; /* pointer to a link in the hash chain */
+
+    /* find the entry to reuse */
+    for (c = 0; c < CACHESIZE; ++c)
+	if (squarecache[c].contents == STALE)
+	    return c;
+	else if (squarecache[c].lastused < squarecache[oldest].lastused)
+	    oldest = c;
+
+    /* remove it from its hash chain */
+    link = &cachechains[squarecache[oldest].contents % CACHEBUCKETS];
+    while (*link != oldest)
+	link = &squarecache[*link].next;
+    *link = squarecache[oldest].next;
+    return oldest;
+}
 
-    /* load the border and panel graphics */
-    if (! (border = bit_read (input)))
-	fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
-    for (c = 0; c < 3; ++c)
-	if (! (panels[c] = bit_read (input)))
-	    fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
+/**
+ * Add the screen to the recording. Each capture is written when the
+ * next is taken, as only then is it known how long it was shown.
+ */
+static void capturescreen (void)
+{
+    clock_t now; /* the time of this capture */
+    int delay; /* time the last capture was shown in 1/100 seconds */
+
+    /* write the last capture unless it was gone too soon to see */
+    now = clock ();
+    delay = (int) ((now - captureclock) * 100 / CLOCKS_PER_SEC);
+    if (delay >= 2) {
+	gif_frame (capture, captureframe, delay);
+	captureclock = now;
+    }
 
-    /* read the robots */
-    for (c = 0; c < 7; ++c)
-	for (f = 0; f < 4; ++f) {
-	    if (! (robots[c][f] = bit_read (input)))
-		fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
-	    if (! (robotmasks[c][f] = bit_read (input)))
-		fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
-	}
+    /* capture the screen as it is now */
+    scr_get (screen, captureframe, 0, 0);
+}
 
-    /* read the items */
-    for (c = 0; c < 6; ++c) {
-	if (! (items[c] = bit_read (input)))
-	    fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
-	if (! (itemmasks[c] = bit_read (input)))
-	    fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
-    }
+/*----------------------------------------------------------------------
+ * Level 1 Private Function Definitions.
+ */
 
-    /* load various one-off sprites */
-    if (! (cursor = bit_read (input)))
-	fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
-    if (! (cursormask = bit_read (input)))
-	fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
-    if (! (blast = bit_read (input)))
-	fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
-    if (! (blastmask = bit_read (input)))
-	fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
-    if (! (bump = bit_read (input)))
-	fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
-    if (! (bumpmask = bit_read (input)))
-	fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
+/**
+ * Encode what should be drawn on a level map square.
+ * @param  level    The level to show.
+ * @param  location The location to encode.
+ * @return          The cell, occupant and facing as one value.
+ */
+static unsigned int squarecontents (Level *level, int location)
+{
+    unsigned int contents; /* the encoded contents */
+    Robot *robot; /* robot at the cell */
+    Item *item; /* item at the cell */
+    contents = level->cells[location]->type;
+    if ((robot = level->robots[location]))
+	contents |= (robot->type << 4) | (robot->facing << 8);
+    else if ((item = level->items[location]))
+	contents |= item->type << 12;
+    return contents;
+}
 
-    /* load the map cell tiles */
-    for (c = 0; c < 12; ++c)
-	if (! (maptiles[c] = bit_read (input)))
-	    fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
 
-    /* load the action tiles */
-    for (c = 0; c < 12; ++c)
-	if (! (actiontiles[c] = bit_read (input)))
-	    fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
+/**
+ * Get a bitmap of a map square with its occupant drawn on the tile,
+ * compositing it if it is not already in the cache.
+ * @param  contents The square contents, as from squarecontents().
+ * @return          The composited bitmap.
+ */
+static Bitmap *getcachedsquare (unsigned int contents)
+{
+    int c, /* cache entry */
+	type, /* robot or item type */
+	facing; /* facing of a robot */
+    CachedSquare *entry; /* pointer to the cache entry */
+
+    /* restart the clock before it wraps round */
+    if (++cacheclock == 0)
+	clearsquarecache ();
+
+    /* look for the square in the cache */
+    for (c = cachechains[contents % CACHEBUCKETS]; c != -1;
+	 c = squarecache[c].next)
+	if (squarecache[c].contents == contents) {
+	    squarecache[c].lastused = cacheclock;
+	    return squarecache[c].bitmap;
+	}
 
-    /* load the phaser sprites */
-    for (c = 0; c < 2; ++c) {
-	if (! (phaserbeams[c] = bit_read (input)))
-	    fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
-	if (! (phasermasks[c] = bit_read (input)))
-	    fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
+    /* make room for it */
+    c = evictsquare ();
+    entry = &squarecache[c];
+    entry->contents = contents;
+    entry->lastused = cacheclock;
+    entry->next = cachechains[contents % CACHEBUCKETS];
+    cachechains[contents % CACHEBUCKETS] = c;
+
+    /* composite the tile and any robot or item */
+    bit_put (entry->bitmap, maptiles[(contents & 0xf) - 1], 0, 0,
+	     DRAW_PSET);
+    if ((type = (contents >> 4) & 0xf)) {
+	facing = (contents >> 8) & 0xf;
+	bit_putmasked (entry->bitmap, robots[type - 1][facing],
+		       robotmasks[type - 1][facing], 0, 0);
+    } else if ((type = contents >> 12)) {
+	bit_putmasked (entry->bitmap, items[type - 1], itemmasks[type - 1],
+		       0, 0);
     }
+    return entry->bitmap;
+}
 
-    /* load the RAM/ROM/Inventory filler tiles */
-    for (c = 0; c < 5; ++c)
-	if (! (ramtiles[c] = bit_read (input)))
-	    fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
-
-    /* load the progress bar */
-    for (c = 0; c < 4; ++c)
-	if (! (progressbar[c] = bit_read (input)))
-	    fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
+/**
+ * Read the table of contents of the asset file, show the logo and
+ * load the robot details. The other assets are loaded as they are
+ * needed, though the title screen and font are loaded while the logo
+ * is on show.
+ */
+static void loadassets (void)
+{
+    FILE *input; /* input file */
+    char toc[ASSETS_TOCSIZE], /* header and table of contents */
+	*data; /* position in the asset data */
+    Bitmap *logo; /* the Cyningstan logo */
+    time_t start; /* time the Cyningstan logo was displayed */
+    int c; /* section counter */
 
-    /* load the dialog box border */
-    if (! (dialoguebox = bit_read (input)))
+    /* open input file and read the table of contents */
+    start = time (NULL);
+    if (! (input = fopen (ASSETS_FILENAME, "rb")))
+	fatalerror (FATAL_NODATA, __FILE__, __LINE__);
+    else if (! fread (toc, ASSETS_TOCSIZE, 1, input))
 	fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
-
-    /* load the font and initialise the screen with it */
-    if (! (font = fnt_read (input)))
+    else if (strcmp (toc, ASSETS_HEADER))
 	fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
-    scr_font (screen, font);
-
-    /* create the highlighted and lowlighted fonts */
-    highfont = fnt_copy (font);
-    fnt_colours (highfont, 3, 2);
-    lowfont = fnt_copy (font);
-    fnt_colours (lowfont, 1, 0);
-
-    /* load the sound effects */
-    for (c = 0; c < 9; ++c) {
-	if (! (noises[c] = new_Effect ()))
-	    fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
-	if (! (noises[c]->read (noises[c], input)))
+    fclose (input);
+    for (c = 0; c < ASSETS_LAST; ++c) {
+	assetoffsets[c] = assetnumber (&toc[8 + ASSETS_ENTRYSIZE * c], 4);
+	assetsizes[c] = (unsigned int)
+	    assetnumber (&toc[12 + ASSETS_ENTRYSIZE * c], 2);
+	if (assetoffsets[c] < ASSETS_TOCSIZE)
 	    fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
     }
 
+    /* display the Cyningstan logo */
+    data = readsection (ASSETS_LOGO);
+    logo = viewbitmap (&data);
+    checksection (data, ASSETS_LOGO);
+    scr_put (screen, logo, 96, 92, DRAW_PSET);
+    bit_destroy (logo);
+    freesection (ASSETS_LOGO);
+
     /* load the robot details */
-    loadrobotdetails (input);
+    data = readsection (ASSETS_ROBOTS);
+    checksection (data + 7 * ROBOT_PACKEDSIZE, ASSETS_ROBOTS);
+    loadrobotdetails ((unsigned char *) data);
+    freesection (ASSETS_ROBOTS);
+
+    /* get the title screen ready */
+    loadtitle ();
+    loadfont ();
     
     /* clear the logo after at least three seconds */
     while (time (NULL) < start + 4);
@@ -439,8 +986,7 @@ static void setscreentitle (char *line1, char *line2, char *line3,
 static void showscreentitle (void)
 {
     int l; /* line counter */
-    bit_ink (scrbuf, 3);
-    bit_font (scrbuf, font);
+    bufferfont (3, 0);
     for (l = 0; l < 4; ++l)
 	bit_print (scrbuf, 4, 164 + 8 * l, scrtitle[l]);
     queueupdate (4, 164, 52, 32);
@@ -461,10 +1007,9 @@ static void displaymenu (int count, char **options, int option, int top)
 	if (top + c < count) {
 	    sprintf (optstring, "%-13.13s", options[top + c]);
 	    if (top + c == option)
-		bit_font (scrbuf, highfont);
+		bufferfont (3, 2);
 	    else
-		bit_font (scrbuf, font);
-	    bit_ink (scrbuf, 3);
+		bufferfont (3, 0);
 	    bit_print (scrbuf, 4, 164 + 8 * c, optstring);
 	} else {
 	    bit_ink (scrbuf, 0);
@@ -504,8 +1049,7 @@ static int getdialoguemenu (int count, char **options)
     }
 
     /* show the initial menu */
-    scr_ink (screen, 3);
-    scr_font (screen, lowfont);
+    screenfont (1, 0);
     scr_print (screen, 118, 100, buf);
 
     /* get an option */
@@ -513,25 +1057,25 @@ static int getdialoguemenu (int count, char **options)
     do {
 
 	/* highlight an option */
-	scr_font (screen, highfont);
+	screenfont (3, 2);
 	scr_print (screen, x[option], 100, options[option]);
 
 	/* up/left key pressed */
 	if ((controls->left () || controls->up ()) && option > 0) {
-	    scr_font (screen, lowfont);
+	    screenfont (1, 0);
 	    scr_print (screen, x[option], 100, options[option]);
 	    --option;
-	    scr_font (screen, highfont);
+	    screenfont (3, 2);
 	    scr_print (screen, x[option], 100, options[option]);
 	    controls->release (0);
 	}
 
 	/* right/down key pressed */
 	else if ((controls->right () || controls->down()) && option < count - 1) {
-	    scr_font (screen, lowfont);
+	    screenfont (1, 0);
 	    scr_print (screen, x[option], 100, options[option]);
 	    ++option;
-	    scr_font (screen, highfont);
+	    screenfont (3, 2);
 	    scr_print (screen, x[option], 100, options[option]);
 	    controls->release (0);
 	}
@@ -575,8 +1119,7 @@ static int getdialoguemenuwithnoise (int count, char **options, int noiseid)
     }
 
     /* show the initial menu */
-    scr_ink (screen, 3);
-    scr_font (screen, lowfont);
+    screenfont (1, 0);
     scr_print (screen, 118, 100, buf);
     display->playsound (noiseid);
 
@@ -585,25 +1128,25 @@ static int getdialoguemenuwithnoise (int count, char **options, int noiseid)
     do {
 
 	/* highlight an option */
-	scr_font (screen, highfont);
+	screenfont (3, 2);
 	scr_print (screen, x[option], 100, options[option]);
 
 	/* up/left key pressed */
 	if ((controls->left () || controls->up ()) && option > 0) {
-	    scr_font (screen, lowfont);
+	    screenfont (1, 0);
 	    scr_print (screen, x[option], 100, options[option]);
 	    --option;
-	    scr_font (screen, highfont);
+	    screenfont (3, 2);
 	    scr_print (screen, x[option], 100, options[option]);
 	    controls->release (0);
 	}
 
 	/* right/down key pressed */
 	else if ((controls->right () || controls->down()) && option < count - 1) {
-	    scr_font (screen, lowfont);
+	    screenfont (1, 0);
 	    scr_print (screen, x[option], 100, options[option]);
 	    ++option;
-	    scr_font (screen, highfont);
+	    screenfont (3, 2);
 	    scr_print (screen, x[option], 100, options[option]);
 	    controls->release (0);
 	}
@@ -660,11 +1203,10 @@ static void showscoreline (int line, Score *score, int levels,
     strcat (linebuf, scorebuf);
 
     /* output the score line */
-    bit_ink (scrbuf, 3);
     if (highlight)
-	bit_font (scrbuf, font);
+	bufferfont (3, 0);
     else
-	bit_font (scrbuf, lowfont);
+	bufferfont (1, 0);
     bit_print (scrbuf, 60, 76 + 8 * line, linebuf);
 }
 
@@ -675,8 +1217,7 @@ static void showscoreline (int line, Score *score, int levels,
  */
 static void showcursor (int x, int y)
 {
-    scr_put (screen, cursormask, x, y, DRAW_AND);
-    scr_put (screen, cursor, x, y, DRAW_OR);
+    scr_putmasked (screen, cursor, cursormask, x, y);
 }
 
 /**
@@ -694,6 +1235,50 @@ static void hidecursor (int x, int y)
  * Public Method Function Definitions.
  */
 
+/**
+ * Start recording the screen to an animated GIF, if enabled.
+ * @param levelid The level being played.
+ * @param turnno  The turn being played.
+ */
+static void startcapture (int levelid, int turnno)
+{
+    char filename[13]; /* name of the GIF file */
+
+    /* only record if asked to, and if not recording already */
+    if (! captureenabled || capture)
+	return;
+
+    /* open the file and start the GIF, giving up quietly on failure */
+    sprintf (filename, "l%02dt%03d.gif", levelid + 1, turnno + 1);
+    if (! (captureoutput = fopen (filename, "wb")))
+	return;
+    if (! (captureframe = bit_create (320, 200)) ||
+	! (capture = gif_create (screen, captureoutput, 320, 200))) {
+	if (captureframe)
+	    bit_destroy (captureframe);
+	fclose (captureoutput);
+	return;
+    }
+
+    /* the screen as it is now is the first frame */
+    scr_get (screen, captureframe, 0, 0);
+    captureclock = clock ();
+}
+
+/**
+ * Stop recording the screen and finish the GIF.
+ */
+static void stopcapture (void)
+{
+    if (capture) {
+	gif_frame (capture, captureframe, 300);
+	gif_destroy (capture);
+	fclose (captureoutput);
+	bit_destroy (captureframe);
+	capture = NULL;
+    }
+}
+
 /**
  * Destroy the display when no longer needed.
  */
@@ -705,69 +1290,29 @@ static void destroy ()
     /* clean up the display */
     if (display) {
 
+	/* finish any recording */
+	stopcapture ();
+
 	/* back to text mode */
 	scr_destroy (screen);
 
 	/* destroy graphical assets */
-	if (title)
-	    bit_destroy (title);
-	if (panels[PANEL_BLANK])
-	    bit_destroy (panels[PANEL_BLANK]);
-	if (panels[PANEL_DEPLOY])
-	    bit_destroy (panels[PANEL_DEPLOY]);
-	if (panels[PANEL_PROGRAM])
-	    bit_destroy (panels[PANEL_PROGRAM]);
-	if (cursor)
-	    bit_destroy (cursor);
-	if (cursormask)
-	    bit_destroy (cursormask);
-	if (bump)
-	    bit_destroy (bump);
-	if (bumpmask)
-	    bit_destroy (bumpmask);
-	if (blast)
-	    bit_destroy (cursor);
-	if (blastmask)
-	    bit_destroy (cursormask);
-	if (border)
-	    bit_destroy (border);
-	for (c = 0; c < 12; ++c)
-	    if (maptiles[c])
-		bit_destroy (maptiles[c]);
-	for (c = 0; c < 12; ++c)
-	    if (actiontiles[c])
-		bit_destroy (actiontiles[c]);
-	for (c = 0; c < 6; ++c)
-	    if (items[c])
-		bit_destroy (items[c]);
-	for (c = 0; c < 6; ++c)
-	    if (items[c])
-		bit_destroy (itemmasks[c]);
-	for (c = 0; c < 5; ++c)
-	    if (ramtiles[c])
-		bit_destroy (ramtiles[c]);
-/*
-	for (c = 0; c < 4; ++c)
-	    if (progressbar[c])
-		bit_destroy (progressbar[c]);
-*/
-	if (dialoguebox)
-	    bit_destroy (dialoguebox);
+	releasetitle ();
+	releasegraphics ();
+	for (c = 0; c < CACHESIZE; ++c)
+	    if (squarecache[c].bitmap)
+		bit_destroy (squarecache[c].bitmap);
+	for (c = 0; c < DISPLAY_MAXBEAMS; ++c)
+	    if (beamunders[c].bitmap)
+		bit_destroy (beamunders[c].bitmap);
 
 	/* destroy fonts */
-	if (font)
-	    fnt_destroy (font);
-	if (highfont)
-	    fnt_destroy (highfont);
-	if (lowfont)
-	    fnt_destroy (lowfont);
+	releasefont ();
 
 	/* destroy music and sounds */
 	if (tune)
 	    tune->destroy (tune);
-	for (c = 0; c < 9; ++c)
-	    if (noises[c])
-		noises[c]->destroy (noises[c]);
+	releasenoises ();
 
 	/* destroy the display itself */
     	free (display);
@@ -788,25 +1333,28 @@ static void setgame (Game *ingame)
  */
 static void update (void)
 {
-    DisplayList *curr, /* current display list entry */
-	*next; /* next display list entry */
-
-    /* loop through all display list entries */
-    curr = displaylist;
-    while (curr) {
-
-	/* update the screen */
-	scr_putpart (screen, scrbuf, curr->x, curr->y, curr->x, curr->y,
-		     curr->w, curr->h, DRAW_PSET);
+    int r, /* tile row counter */
+	c, /* tile column counter */
+	left; /* first tile column of a span */
+
+    /* look for spans of dirty tiles on each row */
+    PROFILE_START (PROFILE_UPDATE);
+    for (r = 0; r < TILEROWS; ++r) {
+	for (c = dirtyfirst[r]; c < dirtylast[r]; ++c) {
+	    if (! dirty[r][c])
+		continue;
+	    for (left = c; c < dirtylast[r] && dirty[r][c]; ++c);
+	    updatespan (r, left, c);
+	}
 
-	/* look at the next entry */
-	next = curr->next;
-	free (curr);
-	curr = next;
+	/* the whole row is clean now */
+	dirtyfirst[r] = dirtylast[r] = 0;
     }
+    PROFILE_STOP (PROFILE_UPDATE);
 
-    /* clear the display list */
-    displaylist = NULL;
+    /* add the updated screen to any recording */
+    if (capture)
+	capturescreen ();
 }
 
 /**
@@ -867,13 +1415,11 @@ static int menu (int count, char **options, int initial)
  */
 static int dialogue (char *message, int count, char **options)
 {
-    Bitmap *customdialogue; /* bitmap for the dialogue */
     char buf[37]; /* buffer for the message */
     int option; /* option chosen */
 
     /* initialise the dialogue */
-    if (! (customdialogue = bit_copy (dialoguebox)))
-	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+    bit_put (customdialogue, dialoguebox, 0, 0, DRAW_PSET);
     centreline (buf, message, 36);
     bit_font (customdialogue, font);
     bit_print (customdialogue, 8, 8, buf);
@@ -883,7 +1429,6 @@ static int dialogue (char *message, int count, char **options)
     option = getdialoguemenu (count, options);
 
     /* clean up and return */
-    bit_destroy (customdialogue);
     queueupdate (110, 84, 160, 32);
     display->update ();
     return option;
@@ -900,13 +1445,11 @@ static int dialogue (char *message, int count, char **options)
 static int dialoguewithnoise (char *message, int count, char **options,
 			      int noiseid)
 {
-    Bitmap *customdialogue; /* bitmap for the dialogue */
     char buf[37]; /* buffer for the message */
     int option; /* option chosen */
 
     /* initialise the dialogue */
-    if (! (customdialogue = bit_copy (dialoguebox)))
-	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+    bit_put (customdialogue, dialoguebox, 0, 0, DRAW_PSET);
     centreline (buf, message, 36);
     bit_font (customdialogue, font);
     bit_print (customdialogue, 8, 8, buf);
@@ -916,7 +1459,6 @@ static int dialoguewithnoise (char *message, int count, char **options,
     option = getdialoguemenuwithnoise (count, options, noiseid);
 
     /* clean up and return */
-    bit_destroy (customdialogue);
     queueupdate (110, 84, 160, 32);
     display->update ();
     return option;
@@ -930,33 +1472,15 @@ static int dialoguewithnoise (char *message, int count, char **options,
 static void showlevelmapsquare (Level *level, int location)
 {
     int x, /* x coordinate of cell */
-	y, /* y coordinate of cell */
-	type, /* type of cell, robot or item */
-	facing; /* facing of a robot at the cell */
-    Robot *robot; /* robot at the cell */
-    Item *item; /* item at the cell */
+	y; /* y coordinate of cell */
 
     /* work out cell coordinates on the screen */
     x = 60 + 16 * (location % 16);
     y = 4 + 16 * (location / 16);
 
-    /* show the cell type */
-    type = level->cells[location]->type;
-    bit_put (scrbuf, maptiles[type - 1], x, y, DRAW_PSET);
-
-    /* show any robot present */
-    if ((robot = level->robots[location])) {
-	type = robot->type;
-	facing = robot->facing;
-	bit_put (scrbuf, robotmasks[type - 1][facing], x, y, DRAW_AND);
-	bit_put (scrbuf, robots[type - 1][facing], x, y, DRAW_OR);
-    }
-
-    /* show any item present */
-    else if ((item = level->items[location])) {
-	bit_put (scrbuf, itemmasks[item->type - 1], x, y, DRAW_AND);
-	bit_put (scrbuf, items[item->type - 1], x, y, DRAW_OR);
-    }
+    /* show the cell with anything on it, remembering what was drawn */
+    shadow[location] = squarecontents (level, location);
+    bit_put (scrbuf, getcachedsquare (shadow[location]), x, y, DRAW_PSET);
 
     /* queue an update */
     if (! wholemap)
@@ -970,11 +1494,28 @@ static void showlevelmapsquare (Level *level, int location)
 static void showlevelmap (Level *level)
 {
     int c; /* general counter */
+    PROFILE_START (PROFILE_SHOWLEVELMAP);
     wholemap = 1;
     for (c = 0; c < 192; ++c)
 	showlevelmapsquare (level, c);
     wholemap = 0;
     queueupdate (60, 4, 256, 192);
+    PROFILE_STOP (PROFILE_SHOWLEVELMAP);
+}
+
+/**
+ * Show the squares of a level that have changed since they were
+ * last drawn.
+ * @param level The level to show.
+ */
+static void showlevelmapchanges (Level *level)
+{
+    int c; /* general counter */
+    PROFILE_START (PROFILE_SHOWLEVELMAP);
+    for (c = 0; c < 192; ++c)
+	if (shadow[c] != squarecontents (level, c))
+	    showlevelmapsquare (level, c);
+    PROFILE_STOP (PROFILE_SHOWLEVELMAP);
 }
 
 /**
@@ -983,8 +1524,12 @@ static void showlevelmap (Level *level)
  */
 static void playsound (int id)
 {
+    PROFILE_START (PROFILE_SOUND);
+    if (soundenabled)
+	loadnoises ();
     if (soundenabled && noises[id])
 	noises[id]->play (noises[id]);
+    PROFILE_STOP (PROFILE_SOUND);
 }
 
 /**
@@ -993,8 +1538,8 @@ static void playsound (int id)
  */
 static void showtitlescreen (void)
 {
-    scr_font (screen, font);
-    scr_ink (screen, 3);
+    loadtitle ();
+    screenfont (3, 0);
     scr_put (screen, title, 0, 0, DRAW_PSET);
     scr_print (screen, 128, 188, " Please wait... ");
 }
@@ -1007,9 +1552,13 @@ static void titlekey (void)
 {
     int key; /* value of key pressed */
 
+    /* load what the game needs while "Please wait..." is shown */
+    loadgraphics ();
+    if (soundenabled)
+	loadnoises ();
+
     /* show the"Press FIRE" message */
-    scr_font (screen, font);
-    scr_ink (screen, 3);
+    screenfont (3, 0);
     scr_print (screen, 128, 188, "   Press FIRE   ");
 
     /* play the tune or wait for a key until FIRE is pressed */
@@ -1026,6 +1575,9 @@ static void titlekey (void)
     scr_ink (screen, 0);
     scr_box (screen, 128, 188, 64, 8);
     while (controls->fire ());
+
+    /* the title screen is not needed again */
+    releasetitle ();
 }
 
 /**
@@ -1043,7 +1595,7 @@ static void shownewgame (char *name, char *player, char *packname)
     bit_put (scrbuf, border, 60, 0, DRAW_PSET);
 
     /* show the window title */
-    bit_font (scrbuf, lowfont);
+    bufferfont (1, 0);
     bit_print (scrbuf, 164, 44, "GAME DETAILS");
     setscreentitle ("", "SET UP", "GAME", "");
     showscreentitle ();
@@ -1071,11 +1623,11 @@ static void showgameoption (char *game, char *player, char *packname,
 
     /* choose the correct font */
     if (highlight > 0)
-	bit_font (scrbuf, highfont);
+	bufferfont (3, 2);
     else if (highlight < 0)
-	bit_font (scrbuf, lowfont);
+	bufferfont (1, 0);
     else
-	bit_font (scrbuf, font);
+	bufferfont (3, 0);
 
     /* format the line text */
     switch (line) {
@@ -1091,7 +1643,6 @@ static void showgameoption (char *game, char *player, char *packname,
     }
 
     /* output the line text */
-    bit_ink (scrbuf, 3);
     bit_print (scrbuf, 132, 84 + 32 * line, text);
     queueupdate (132, 84 + 32 * line, 116, 8);
 }
@@ -1103,7 +1654,7 @@ static void showgameoption (char *game, char *player, char *packname,
 static void renameplayer (char *name)
 {
     edittext (name, 13, 168, 116);
-    bit_font (scrbuf, font);
+    bufferfont (3, 0);
     bit_print (scrbuf, 168, 116, name);
     queueupdate (168, 116, 52, 8);
 }
@@ -1129,17 +1680,17 @@ static void showscorescreen (char *title1, char *title2, char *packname,
     bit_put (scrbuf, border, 60, 0, DRAW_PSET);
 
     /* show the window title */
-    bit_font (scrbuf, lowfont);
+    bufferfont (1, 0);
     setscreentitle ("", title1, title2, "");
     showscreentitle ();
 
     /* table heading */
-    bit_font (scrbuf, font);
+    bufferfont (3, 0);
     centreline (linebuffer, packname, 63);
     bit_print (scrbuf, 60, 28, linebuffer);
     centreline (linebuffer, "Twelve Best Scores", 63);
     bit_print (scrbuf, 60, 36, linebuffer);
-    bit_font (scrbuf, lowfont);
+    bufferfont (1, 0);
     sprintf (linebuffer, "%48sLevel   Pack", "");
     bit_print (scrbuf, 60, 52, linebuffer);
     sprintf (linebuffer,
@@ -1170,12 +1721,12 @@ static void showdeploymentscreen (Robot **robots, Level *level)
     bit_put (scrbuf, border, 60, 0, DRAW_PSET);
 
     /* show the window title */
-    bit_font (scrbuf, lowfont);
+    bufferfont (1, 0);
     setscreentitle ("", "ROBOT", "DEPLOYMENT", "");
     showscreentitle ();
 
     /* show level details */
-    bit_font (scrbuf, font);
+    bufferfont (3, 0);
     bit_print (scrbuf, 8, 8, game->levelpack->name);
     sprintf (buf, "Level %02d", game->levelid + 1);
     bit_print (scrbuf, 8, 16, buf);
@@ -1335,11 +1886,10 @@ static void showrobottodeploy (Robot *robot)
     char buf[10]; /* string buffer */
     bit_put (scrbuf, robots[robot->type - 1][2], 4, 48, DRAW_PSET);
     sprintf (buf, "%-9.9s", robot->name);
-    bit_font (scrbuf, font);
-    bit_ink (scrbuf, 3);
+    bufferfont (3, 0);
     bit_print (scrbuf, 20, 48, buf);
     sprintf (buf, "%-9.9s", robot->x == 0xff ? "Reserved" : "Deployed");
-    bit_font (scrbuf, lowfont);
+    bufferfont (1, 0);
     bit_print (scrbuf, 20, 56, buf);
     queueupdate (4, 48, 52, 16);
 }
@@ -1360,12 +1910,12 @@ static void showprogrammingscreen (Action **library, Robot *robot,
     bit_put (scrbuf, border, 60, 0, DRAW_PSET);
 
     /* show the window title */
-    bit_font (scrbuf, lowfont);
+    bufferfont (1, 0);
     setscreentitle ("", "ROBOT", "PROGRAMMING", "");
     showscreentitle ();
 
     /* show level details */
-    bit_font (scrbuf, font);
+    bufferfont (3, 0);
     bit_print (scrbuf, 4, 4, game->levelpack->name);
     sprintf (buf, "Level %02d", game->levelid + 1);
     bit_print (scrbuf, 4, 12, buf);
@@ -1587,8 +2137,7 @@ static void showrobottoprogram (Robot *robot, Level *level)
 
     /* show the robot name and icon */
     sprintf (buf, "%-9.9s", robot->name);
-    bit_font (scrbuf, font);
-    bit_ink (scrbuf, 3);
+    bufferfont (3, 0);
     bit_print (scrbuf, 4, 20, buf);
     bit_put (scrbuf, robots[robot->type - 1][2], 40, 12, DRAW_PSET);
 
@@ -1640,7 +2189,7 @@ static void showactionscreen (Level *level)
     bit_put (scrbuf, border, 60, 0, DRAW_PSET);
 
     /* show the window title */
-    bit_font (scrbuf, lowfont);
+    bufferfont (1, 0);
     setscreentitle ("", "ACTION!", "", "");
     showscreentitle ();
     display->showprogressbar (0);
@@ -1653,38 +2202,39 @@ static void showactionscreen (Level *level)
 }
 
 /**
- * Show a phaser beam in transit.
- * @param x The x position of the beam.
- * @param y The y position of the beam.
+ * Show a phaser beam in transit, saving the screen behind it.
+ * @param beam   The beam number, below DISPLAY_MAXBEAMS.
+ * @param x      The x position of the beam in pixels across the map.
+ * @param y      The y position of the beam in pixels down the map.
  * @param facing 0 for north/south, 1 for east/west.
  */
-static void showphaserbeam (int x, int y, int facing)
+static void showphaserbeam (int beam, int x, int y, int facing)
 {
-    scr_put (screen, phasermasks[facing], 60 + 16 * x, 4 + 16 * y,
-	     DRAW_AND);
-    scr_put (screen, phaserbeams[facing], 60 + 16 * x, 4 + 16 * y,
-	     DRAW_OR);
+    SavedArea *under; /* the saved area behind the beam */
+
+    /* save the screen, with the extra byte an unaligned beam covers */
+    under = &beamunders[beam];
+    under->x = 60 + x - x % 4;
+    under->y = 4 + y;
+    under->width = (x % 4) ? 20 : 16;
+    scr_get (screen, under->bitmap, under->x, under->y);
+
+    /* draw the beam over it */
+    scr_putmasked (screen, phaserbeams[facing], phasermasks[facing],
+		   60 + x, 4 + y);
 }
 
 /**
- * Hide a phaser beam by redisplaying the level map square
- * @param level    The level to show.
- * @param location The location to show.
+ * Hide a phaser beam by restoring the screen saved behind it.
+ * Overlapping beams must be hidden in the reverse order.
+ * @param beam The beam number.
  */
-static void hidephaserbeam (Level *level, int location)
+static void hidephaserbeam (int beam)
 {
-    int x, /* x coordinate of cell */
-	y, /* y coordinate of cell */
-	type; /* cell type */
-
-    /* work out cell coordinates on the screen */
-    x = 60 + 16 * (location % 16);
-    y = 4 + 16 * (location / 16);
-
-    /* show the cell type */
-    type = level->cells[location]->type;
-    scr_put (screen, maptiles[type - 1], x, y, DRAW_PSET);
-
+    SavedArea *under; /* the saved area behind the beam */
+    under = &beamunders[beam];
+    scr_putpart (screen, under->bitmap, under->x, under->y, 0, 0,
+		 under->width, 16, DRAW_PSET);
 }
 
 /**
@@ -1694,10 +2244,8 @@ static void hidephaserbeam (Level *level, int location)
  */
 static void showblast (int x, int y)
 {
-    scr_put (screen, blastmask, 60 + 16 * x, 4 + 16 * y,
-	     DRAW_AND);
-    scr_put (screen, blast, 60 + 16 * x, 4 + 16 * y,
-	     DRAW_OR);
+    shadow[x + 16 * y] = STALE;
+    scr_putmasked (screen, blast, blastmask, 60 + 16 * x, 4 + 16 * y);
 }
 
 /**
@@ -1727,12 +2275,14 @@ static void showprogressbar (int count)
  * Display constructor.
  * @param colourset = 0 for mono, 1 for colour, 2 for nice colour.
  * @param quiet = 0 for sound and music, 1 for silence.
+ * @param record = 1 to record action playback as animated GIFs.
  * @return the new display.
  */
-Display *new_Display (int colourset, int quiet)
+Display *new_Display (int colourset, int quiet, int record)
 {
     /* local variables */
-    int mode; /* the screen mode */
+    int mode, /* the screen mode */
+	c; /* counter */
 
     /* allocate memory */
     if (display)
@@ -1744,10 +2294,13 @@ Display *new_Display (int colourset, int quiet)
     display->destroy = destroy;
     display->setgame = setgame;
     display->update = update;
+    display->startcapture = startcapture;
+    display->stopcapture = stopcapture;
     display->menu = menu;
     display->dialogue = dialogue;
     display->dialoguewithnoise = dialoguewithnoise;
     display->showlevelmap = showlevelmap;
+    display->showlevelmapchanges = showlevelmapchanges;
     display->showlevelmapsquare = showlevelmapsquare;
     display->playsound = playsound;
 
@@ -1791,8 +2344,9 @@ Display *new_Display (int colourset, int quiet)
     /* initialise the game controls handler */
     controls = getcontrols ();
 
-    /* store sound settings */
+    /* store sound and recording settings */
     soundenabled = ! quiet;
+    captureenabled = record;
 
     /* prepare to initialise the CGALIB screen */
     if (colourset == 0)
@@ -1814,8 +2368,17 @@ Display *new_Display (int colourset, int quiet)
     /* create the off-screen buffer */
     scrbuf = bit_create (320, 200);
 
+    /* create the square cache and phaser beam save-under bitmaps */
+    for (c = 0; c < CACHESIZE; ++c)
+	if (! (squarecache[c].bitmap = bit_create (16, 16)))
+	    fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+    for (c = 0; c < DISPLAY_MAXBEAMS; ++c)
+	if (! (beamunders[c].bitmap = bit_create (20, 16)))
+	    fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+
     /* initialise the assets */
     loadassets ();
+    clearsquarecache ();
 
     /* initialise the screen title */
     setscreentitle ("", "", "", "");
@@ -0,0 +1,697 @@
+/*======================================================================
+ * Team Droid: Jam Edition
+ * A programming puzzle game with cute robots.
+ *
+ * Copyright (C) Damian Gareth Walker, 2022.
+ * Turn Resolution Engine Module.
+ */
+
+/*----------------------------------------------------------------------
+ * Required Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/* project specific headers */
+#include "engine.h"
+#include "level.h"
+#include "robot.h"
+#include "item.h"
+#include "cell.h"
+#include "action.h"
+#include "fatal.h"
+
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/** @var xoffset The x offset for each facing. */
+static int xoffset[] = {
+    0, /* north */
+    +1, /* east */
+    0, /* south */
+    -1 /* west */
+};
+
+/** @var xoffset The x offset for each facing. */
+static int yoffset[] = {
+    -1, /* north */
+    0, /* east */
+    +1, /* south */
+    0 /* west */
+};
+
+/*----------------------------------------------------------------------
+ * Level 3 Function Definitions.
+ */
+
+/**
+ * Record an event, if an event list is being kept.
+ * @param  events The event list, or NULL.
+ * @param  type   The event type.
+ * @param  x      The x coordinate of the event.
+ * @param  y      The y coordinate of the event.
+ * @param  value  The event value.
+ * @return        A pointer to the new event, or NULL.
+ */
+static Event *record (EventList *events, int type, int x, int y,
+		      int value)
+{
+    if (! events)
+	return NULL;
+    return events->add (events, type, x, y, value);
+}
+
+/**
+ * Find the items in a row that are not being carried by a robot.
+ * @param  level The level to look at.
+ * @param  row   The row number.
+ * @return       A bitboard row with a bit set for each loose item.
+ */
+static unsigned int looseitems (Level *level, int row)
+{
+    unsigned int items = 0; /* the items in the row */
+    int t; /* item type counter */
+    for (t = ITEM_SPAWNER; t < ITEM_LAST; ++t)
+	items |= level->itemmasks[t][row];
+    return items & ~(level->playermask[row] | level->guardmask[row]);
+}
+
+#ifdef DEBUG
+/**
+ * Check the level's counters against a full scan of the map.
+ * @param level The level to check.
+ */
+static void checkcounters (Level *level)
+{
+    int c, /* cell counter */
+	readers = 0, /* number of readers found */
+	cards = 0, /* number of data cards found */
+	cardsread = 0, /* number of readers with cards found */
+	robotcount = 0; /* number of player robots found */
+
+    /* count up the things that the level keeps counters for */
+    for (c = 0; c < 192; ++c) {
+	if (level->cells[c]->type == CELL_READER)
+	    ++readers;
+	if (level->items[c] && level->items[c]->type == ITEM_CARD) {
+	    ++cards;
+	    if (level->cells[c]->type == CELL_READER)
+		++cardsread;
+	}
+	if (level->robots[c] && level->robots[c]->type != ROBOT_GUARD)
+	    ++robotcount;
+    }
+
+    /* compare the counts */
+    assert (readers == level->readers);
+    assert (cards == level->cards);
+    assert (cardsread == level->cardsread);
+    assert (robotcount == level->robotcount);
+}
+#endif
+
+/*----------------------------------------------------------------------
+ * Level 2 Function Definitions.
+ */
+
+/**
+ * Reset the statuses of all surviving robots.
+ * @param robots     The robots in priority order.
+ * @param robotcount The number of entries in the robot list.
+ */
+static void resetrobotstatuses (Robot **robots, int robotcount)
+{
+    int r; /* robot counter */
+    for (r = 0; r < robotcount; ++r)
+	if (robots[r])
+	    robots[r]->status = ROBOT_INERT;
+}
+
+/**
+ * Remove robots that are destroyed.
+ * @param  level      The level to scan.
+ * @param  robots     The robots in priority order.
+ * @param  robotcount The number of entries in the robot list.
+ * @param  events     The event list, or NULL.
+ * @return            1 if any robots were destroyed.
+ */
+static int checkdestroyedrobots (Level *level, Robot **robots,
+				 int robotcount, EventList *events)
+{
+    int r, /* robot counter */
+	destroyed = 0; /* robots destroyed */
+
+    /* scan the robot list for destroyed robots */
+    for (r = 0; r < robotcount; ++r)
+	if (! robots[r])
+	    ; /* no robot here */
+	else if (robots[r]->status == ROBOT_DESTROYED) {
+	    record (events, EVENT_DESTROYROBOT, robots[r]->x,
+		    robots[r]->y, robots[r]->type);
+	    level->setrobot (level, robots[r]->x + 16 * robots[r]->y, NULL);
+	    robots[r]->destroy (robots[r]);
+	    robots[r] = NULL;
+	    destroyed = 1;
+	}
+
+    /* return 1 if robots were destroyed */
+    return destroyed;
+}
+
+/**
+ * Remove items that are destroyed, without resetting other statuses.
+ * @param  level  The level to scan for items.
+ * @param  events The event list, or NULL.
+ * @return        1 if any items were destroyed
+ */
+static int checkdestroyeditems (Level *level, EventList *events)
+{
+    int c, /* cell counter */
+	destroyed = 0; /* 1 if items were destroyed */
+    unsigned int row = 0; /* loose items left in the current row */
+    Item *item; /* pointer to an item */
+
+    /* scan the map for items not being carried */
+    for (c = 0; c < 192; ++c) {
+	if (c % 16 == 0)
+	    row = looseitems (level, c / 16);
+	if (! row) {
+	    c |= 15;
+	    continue;
+	}
+	if (! (row & LEVEL_BIT (c)))
+	    continue;
+	row &= ~LEVEL_BIT (c);
+	item = level->items[c];
+	if (item->status == ITEM_DESTROYED) {
+	    record (events, EVENT_DESTROYITEM, c % 16, c / 16, item->type);
+	    level->setitem (level, c, NULL);
+	    item->destroy (item);
+	    destroyed = 1;
+	}
+    }
+
+    /* return 1 if items were destroyed */
+    return destroyed;
+}
+
+/**
+ * Trace the path of a phaser beam after the shots have been resolved.
+ * The beam stops at the first robot, item or shootable cell.
+ * @param level  The level state.
+ * @param robot  The robot that fired.
+ * @param events The event list.
+ */
+static void traceshot (Level *level, Robot *robot, EventList *events)
+{
+    int x, /* x coordinate of beam */
+	y, /* y coordinate of beam */
+	xf, /* x facing offset */
+	yf, /* y facing offset */
+	pos, /* map position of beam */
+	range = 0, /* number of squares crossed */
+	hit = 0; /* 1 if the beam hits something */
+    Event *event; /* the shot event */
+
+    /* make sure the robot has a phaser */
+    x = robot->x;
+    y = robot->y;
+    if ((! level->items[x + 16 * y] ||
+	 level->items[x + 16 * y]->type != ITEM_PHASER) &&
+	! robot->hasphaser)
+	return;
+
+    /* ignore robots firing off the map */
+    xf = xoffset[robot->facing];
+    yf = yoffset[robot->facing];
+    if (x + xf < 0 || x + xf > 15 || y + yf < 0 || y + yf > 11)
+	return;
+
+    /* follow the beam until it hits something or leaves the map */
+    x += xf;
+    y += yf;
+    event = record (events, EVENT_SHOT, x, y, robot->facing);
+    do {
+	++range;
+	pos = x + 16 * y;
+	if (level->cells[pos]->allowshoot ||
+	    level->items[pos] ||
+	    level->robots[pos])
+	    hit = 1;
+	x += xf;
+	y += yf;
+    } while (! hit && x >= 0 && x <= 15 && y >= 0 && y <= 11);
+
+    /* store the result */
+    event->range = range;
+    event->hit = hit;
+}
+
+/*----------------------------------------------------------------------
+ * Level 1 Function Definitions.
+ */
+
+/**
+ * Resolve the first part of any sprint actions.
+ * @param  level      The level to play on.
+ * @param  robots     The robots in priority order.
+ * @param  robotcount The number of entries in the robot list.
+ * @param  move       The move number.
+ * @param  events     The event list, or NULL.
+ * @return            The number of robots sprinting.
+ */
+static int sprintactions (Level *level, Robot **robots, int robotcount,
+			  int move, EventList *events)
+{
+    Action *action; /* the action to perform */
+    int r, /* robot counter */
+	sprinting = 0; /* number of robots sprinting */
+
+    /* execute any sprint actions */
+    action = get_Action (ACTION_SPRINT);
+    for (r = 0; r < robotcount; ++r)
+	if (robots[r] &&
+	    robots[r]->status != ROBOT_DESTROYED &&
+	    robots[r]->ram[move] == ACTION_SPRINT) {
+	    record (events, EVENT_ACTION, robots[r]->x, robots[r]->y,
+		    ACTION_SPRINT);
+	    action->execute (action, robots[r], level);
+	    ++sprinting;
+	}
+
+    /* remove anything destroyed */
+    checkdestroyedrobots (level, robots, robotcount, events);
+    checkdestroyeditems (level, events);
+    return sprinting;
+}
+
+/**
+ * Resolve any actions except shooting.
+ * @param  level      The level to play on.
+ * @param  robots     The robots in priority order.
+ * @param  robotcount The number of entries in the robot list.
+ * @param  move       The move number.
+ * @param  events     The event list, or NULL.
+ * @return            The number of actions performed.
+ */
+static int generalactions (Level *level, Robot **robots, int robotcount,
+			   int move, EventList *events)
+{
+    Action *action; /* the action to perform */
+    int r, /* robot counter */
+	actionsdone = 0; /* number of actions performed */
+
+    /* execute any non-shooting actions */
+    for (r = 0; r < robotcount; ++r)
+	if (robots[r] &&
+	    robots[r]->status != ROBOT_DESTROYED &&
+	    move < robots[r]->ramsize &&
+	    robots[r]->ram[move] != ACTION_SHOOT &&
+	    robots[r]->ram[move] != ACTION_NONE) {
+	    record (events, EVENT_ACTION, robots[r]->x, robots[r]->y,
+		    robots[r]->ram[move]);
+	    action = get_Action (robots[r]->ram[move]);
+	    action->execute (action, robots[r], level);
+	    ++actionsdone;
+	}
+
+    /* remove anything destroyed */
+    checkdestroyedrobots (level, robots, robotcount, events);
+    checkdestroyeditems (level, events);
+    return actionsdone;
+}
+
+/**
+ * Resolve shoot actions.
+ * @param  level      The level to play on.
+ * @param  robots     The robots in priority order.
+ * @param  robotcount The number of entries in the robot list.
+ * @param  move       The move number.
+ * @param  events     The event list, or NULL.
+ * @return            The number of robots shooting.
+ */
+static int shootactions (Level *level, Robot **robots, int robotcount,
+			 int move, EventList *events)
+{
+    Action *action; /* the action to perform */
+    int r, /* robot counter */
+	shooting = 0; /* number of robots shooting */
+
+    /* execute any shooting actions */
+    action = get_Action (ACTION_SHOOT);
+    for (r = 0; r < robotcount; ++r)
+	if (robots[r] &&
+	    robots[r]->ram[move] == ACTION_SHOOT) {
+	    record (events, EVENT_ACTION, robots[r]->x, robots[r]->y,
+		    ACTION_SHOOT);
+	    action->execute (action, robots[r], level);
+	    ++shooting;
+	}
+
+    /* record the beam paths before anything is removed */
+    if (shooting && events)
+	for (r = 0; r < robotcount; ++r)
+	    if (robots[r] &&
+		robots[r]->ram[move] == ACTION_SHOOT)
+		traceshot (level, robots[r], events);
+
+    /* remove anything destroyed and reset the robot statuses */
+    checkdestroyedrobots (level, robots, robotcount, events);
+    checkdestroyeditems (level, events);
+    resetrobotstatuses (robots, robotcount);
+    return shooting;
+}
+
+/**
+ * Resolve any cell effects.
+ * @param  level      The level to play on.
+ * @param  robots     The robots in priority order.
+ * @param  robotcount The number of entries in the robot list.
+ * @param  move       The move number.
+ * @param  sprint     Effects for sprinting robots only.
+ * @param  events     The event list, or NULL.
+ * @return            The number of effects that happened.
+ */
+static int celleffects (Level *level, Robot **robots, int robotcount,
+			int move, int sprint, EventList *events)
+{
+    int effects = 0, /* number of effects that happened */
+	effect, /* 1 if the current cell had an effect */
+	a, /* active cell counter */
+	c; /* cell location */
+    Cell *cell; /* pointer to current cell */
+    Robot *robot; /* pointer to a robot on a cell */
+
+    /* sweep through the cells that can have an effect */
+    for (a = 0; a < level->activecount; ++a) {
+	c = level->active[a];
+	cell = level->cells[c];
+	robot = level->robots[c];
+	if (sprint && robot && robot->ram[move] != ACTION_SPRINT)
+	    continue;
+	if (robot && move < robot->ramsize)
+	    effect = cell->onrobot (level, c % 16, c / 16);
+	else if (level->items[c])
+	    effect = cell->onitem (level, c % 16, c / 16);
+	else
+	    effect = 0;
+	if (! effect)
+	    continue;
+	if (cell->type == CELL_TELEPORTER)
+	    record (events, EVENT_TELEPORT, c % 16, c / 16, cell->type);
+	else
+	    record (events, EVENT_EFFECT, c % 16, c / 16, cell->type);
+	++effects;
+    }
+
+    /* remove anything destroyed and reset the robot statuses */
+    checkdestroyedrobots (level, robots, robotcount, events);
+    checkdestroyeditems (level, events);
+    resetrobotstatuses (robots, robotcount);
+    return effects;
+}
+
+/*----------------------------------------------------------------------
+ * Public Method Function Definitions.
+ */
+
+/**
+ * Destroy the event list when it is no longer needed.
+ * @param events The event list to destroy.
+ */
+static void destroy (EventList *events)
+{
+    if (events) {
+	if (events->events)
+	    free (events->events);
+	free (events);
+    }
+}
+
+/**
+ * Clear the event list, keeping its memory for reuse.
+ * @param events The event list to clear.
+ */
+static void clear (EventList *events)
+{
+    events->count = 0;
+}
+
+/**
+ * Add an event to the list.
+ * @param  events The event list.
+ * @param  type   The event type.
+ * @param  x      The x coordinate of the event.
+ * @param  y      The y coordinate of the event.
+ * @param  value  The event value.
+ * @return        A pointer to the new event.
+ */
+static Event *add (EventList *events, int type, int x, int y, int value)
+{
+    Event *event; /* the new event */
+
+    /* make room for the event if necessary */
+    if (events->count == events->size) {
+	events->size = events->size ? 2 * events->size : 64;
+	if (! (events->events = realloc
+	       (events->events, events->size * sizeof (Event))))
+	    fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+    }
+
+    /* fill in the event */
+    event = &events->events[events->count++];
+    event->type = type;
+    event->x = x;
+    event->y = y;
+    event->value = value;
+    event->range = 0;
+    event->hit = 0;
+    return event;
+}
+
+/*----------------------------------------------------------------------
+ * Top Level Function Definitions.
+ */
+
+/**
+ * Construct a new event list, with room for the events of a phase.
+ * @return The new event list.
+ */
+EventList *new_EventList (void)
+{
+    EventList *events; /* the new event list */
+
+    /* reserve memory for the event list */
+    if (! (events = malloc (sizeof (EventList))))
+	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+
+    /* initialise methods */
+    events->destroy = destroy;
+    events->clear = clear;
+    events->add = add;
+
+    /* initialise attributes, reserving room for a whole phase */
+    if (! (events->events = malloc (ENGINE_MAXEVENTS * sizeof (Event))))
+	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+    events->count = 0;
+    events->size = ENGINE_MAXEVENTS;
+
+    /* return the new event list */
+    return events;
+}
+
+/**
+ * Put the robots on a level into priority order. The order depends
+ * only on the level layout, so a replay will always match.
+ * @param  level  The level containing the robots.
+ * @param  robots An array with room for every robot on the level.
+ * @return        The number of robots placed in the array.
+ */
+int simulate_priorities (Level *level, Robot **robots)
+{
+    int c, /* cell counter */
+	r, /* robot counter */
+	s, /* swap robot number */
+	seed = 0, /* random number seed */
+	robotcount = 0; /* the number of robots */
+    Robot *swaprobot; /* pointer to a robot to swap */
+
+    /* build the robot list and set a seed for their priorities */
+    for (c = 0; c < 192; ++c) {
+	seed ^= level->cells[c]->type;
+	if (level->robots[c])
+	    robots[robotcount++] = level->robots[c];
+    }
+
+    /* scramble the robot priorities according to the seed */
+    srand (seed);
+    for (r = 0; r < robotcount; ++r) {
+	s = rand () % robotcount;
+	swaprobot = robots[r];
+	robots[r] = robots[s];
+	robots[s] = swaprobot;
+    }
+
+    /* return the number of robots */
+    return robotcount;
+}
+
+/**
+ * Resolve one phase of a move. Destroyed robots are removed from the
+ * level and their entries in the robot list are set to NULL.
+ * @param  level      The level to play on.
+ * @param  robots     The robots in priority order.
+ * @param  robotcount The number of entries in the robot list.
+ * @param  move       The move number, 0 to 7.
+ * @param  phase      The phase to resolve.
+ * @param  events     The list to record events on, or NULL.
+ * @return            Nonzero if any actions or effects happened.
+ */
+int simulate_phase (Level *level, Robot **robots, int robotcount,
+		    int move, int phase, EventList *events)
+{
+    record (events, EVENT_PHASE, move, 0, phase);
+    switch (phase) {
+    case ENGINE_SPRINT:
+	return sprintactions (level, robots, robotcount, move, events);
+    case ENGINE_SPRINTEFFECTS:
+	return celleffects (level, robots, robotcount, move, 1, events);
+    case ENGINE_GENERAL:
+	return generalactions (level, robots, robotcount, move, events);
+    case ENGINE_SHOOT:
+	return shootactions (level, robots, robotcount, move, events);
+    case ENGINE_EFFECTS:
+	return celleffects (level, robots, robotcount, move, 0, events);
+    }
+    return 0;
+}
+
+/**
+ * Resolve all the phases of a single move.
+ * @param  level      The level to play on.
+ * @param  robots     The robots in priority order.
+ * @param  robotcount The number of entries in the robot list.
+ * @param  move       The move number, 0 to 7.
+ * @param  events     The list to record events on, or NULL.
+ * @return            Nonzero if any actions or effects happened.
+ */
+int simulate_move (Level *level, Robot **robots, int robotcount,
+		   int move, EventList *events)
+{
+    int phase, /* phase counter */
+	activity = 0; /* nonzero if anything happened */
+    for (phase = 0; phase < ENGINE_PHASES; ++phase)
+	activity |= simulate_phase (level, robots, robotcount, move,
+				    phase, events);
+    return activity;
+}
+
+/**
+ * Tidy up the level at the end of a turn, removing destroyed items
+ * and resetting the status of the others.
+ * @param level The level to tidy up.
+ */
+void simulate_endturn (Level *level)
+{
+    int c; /* cell counter */
+    unsigned int row = 0; /* loose items left in the current row */
+    Item *item; /* pointer to an item */
+
+    /* scan the map for items not being carried */
+    for (c = 0; c < 192; ++c) {
+	if (c % 16 == 0)
+	    row = looseitems (level, c / 16);
+	if (! row) {
+	    c |= 15;
+	    continue;
+	}
+	if (! (row & LEVEL_BIT (c)))
+	    continue;
+	row &= ~LEVEL_BIT (c);
+	item = level->items[c];
+	if (item->status == ITEM_DESTROYED) {
+	    level->setitem (level, c, NULL);
+	    item->destroy (item);
+	} else
+	    item->status = ITEM_INERT;
+    }
+}
+
+/**
+ * Resolve a whole turn of eight moves.
+ * @param level      The level to play on.
+ * @param robots     The robots in priority order.
+ * @param robotcount The number of entries in the robot list.
+ * @param events     The list to record events on, or NULL.
+ */
+void simulate_turn (Level *level, Robot **robots, int robotcount,
+		    EventList *events)
+{
+    int move; /* move counter */
+    for (move = 0; move < 8; ++move)
+	simulate_move (level, robots, robotcount, move, events);
+    simulate_endturn (level);
+}
+
+/**
+ * Check if a level is complete, with a card on every reader.
+ * @param  level The level to check.
+ * @return       1 if the level is complete, 0 if not.
+ */
+int simulate_complete (Level *level)
+{
+#ifdef DEBUG
+    checkcounters (level);
+#endif
+    return level->cardsread == level->readers;
+}
+
+/**
+ * Check if a level is failed, with no player robots left or too few
+ * data cards for the readers.
+ * @param  level The level to check.
+ * @return       1 if the level is failed, 0 if not.
+ */
+int simulate_failed (Level *level)
+{
+#ifdef DEBUG
+    checkcounters (level);
+#endif
+    if (level->robotcount == 0)
+	return 1; /* no player robots left */
+    if (level->cards < level->readers)
+	return 1; /* data card(s) destroyed */
+    return 0;
+}
+
+/**
+ * Calculate a hash of the state of a level, for checking that a
+ * replay has reached the same position as the original game.
+ * @param  level The level to hash.
+ * @return       The hash value.
+ */
+unsigned long simulate_hash (Level *level)
+{
+    unsigned long hash = 2166136261UL; /* the hash value */
+    int c, /* cell counter */
+	v; /* value counter */
+    unsigned char values[4]; /* values to hash for a cell */
+    for (c = 0; c < 192; ++c) {
+	values[0] = (unsigned char) level->cells[c]->type;
+	values[1] = (unsigned char)
+	    (level->items[c] ? level->items[c]->type : ITEM_NONE);
+	values[2] = (unsigned char)
+	    (level->robots[c] ? level->robots[c]->type : ROBOT_NONE);
+	values[3] = (unsigned char)
+	    (level->robots[c] ? level->robots[c]->facing : 0);
+	for (v = 0; v < 4; ++v)
+	    hash = ((hash ^ values[v]) * 16777619UL) & 0xffffffffUL;
+    }
+    return hash;
+}
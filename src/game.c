@@ -25,9 +25,17 @@
 #include "level.h"
 #include "item.h"
 #include "action.h"
+#include "engine.h"
 #include "uiscreen.h"
 #include "utils.h"
 
+/*----------------------------------------------------------------------
+ * Constants.
+ */
+
+/** @const SUMMARYSIZE The size of the summary that follows the header. */
+#define SUMMARYSIZE 34
+
 /*----------------------------------------------------------------------
  * Data Definitions.
  */
@@ -91,66 +99,53 @@ static void initialiseattributes (Game *game)
     game->state = STATE_NEWGAME;
     game->levelid = 0;
     game->turnno = 0;
+    game->deployed = 0;
+    game->total = 0;
+    game->saved = 0;
 }
 
 /**
- * Check if a level is complete.
- * @param game The game to check.
+ * Pack the game summary into a fixed-size block, so that the summary
+ * can be read without reading the rest of the game. The block holds
+ * the player and level pack file names padded with NULs, the level
+ * reached, the total score and the time saved, least significant
+ * byte first.
+ * @param game    The game to summarise.
+ * @param summary The block to pack into.
  */
-static int checkcomplete (Game *game)
+static void packsummary (Game *game, unsigned char *summary)
 {
-    int readerswithoutcards, /* number of readers needing cards */
-	c; /* cell counter */
-    Level *level; /* pointer to current level */
-
-    /* initialise convenience variables */
-    level = game->level;
-
-    /* do all card readers have a card? */
-    readerswithoutcards = 0;
-    for (c = 0; c < 192; ++c)
-	if (level->cells[c]->type == CELL_READER &&
-	    (! level->items[c] ||
-	     level->items[c]->type != ITEM_CARD))
-	    ++readerswithoutcards;
-    if (! readerswithoutcards)
-	return 1;
-
-    /* no completion detected */
-    return 0;
+    unsigned long saved; /* the time saved */
+    int c; /* byte counter */
+    memset (summary, 0, SUMMARYSIZE);
+    strncpy ((char *) summary, game->player, 13);
+    strncpy ((char *) summary + 14, game->levelpackfile, 12);
+    summary[27] = (unsigned char) game->levelid;
+    summary[28] = (unsigned char) (game->total & 0xff);
+    summary[29] = (unsigned char) ((game->total >> 8) & 0xff);
+    saved = (unsigned long) game->saved;
+    for (c = 0; c < 4; ++c)
+	summary[30 + c] = (unsigned char) ((saved >> (8 * c)) & 0xff);
 }
 
 /**
- * Check if a level is failed.
- * @param game The game to check.
+ * Unpack the game summary from a fixed-size block.
+ * @param game    The game to fill in.
+ * @param summary The block to unpack.
  */
-static int checkfailed (Game *game)
+static void unpacksummary (Game *game, unsigned char *summary)
 {
-    int playerrobots = 0, /* number of player robots remaining */
-	datacards = 0, /* number of data cards remaining */
-	readers = 0, /* number of readers on the map */
-	c; /* general purpose counters */
-    Level *level; /* pointer to current level */
-
-    /* initialise convenience variables */
-    level = game->level;
-
-    /* count up all the things that calculate level failure */
-    for (c = 0; c < 192; ++c) {
-	if (level->robots[c] && level->robots[c]->type != ROBOT_GUARD)
-	    ++playerrobots;
-	if (level->items[c] && level->items[c]->type == ITEM_CARD)
-	    ++datacards;
-	if (level->cells[c]->type == CELL_READER)
-	    ++readers;
-    }
-
-    /* return level failure */
-    if (playerrobots == 0)
-	return 1; /* no player robots left */
-    if (datacards < readers)
-	return 1; /* data card(s) destroyed */
-    return 0;
+    unsigned long saved = 0; /* the time saved */
+    int c; /* byte counter */
+    strncpy (game->player, (char *) summary, 13);
+    game->player[13] = '\0';
+    strncpy (game->levelpackfile, (char *) summary + 14, 12);
+    game->levelpackfile[12] = '\0';
+    game->levelid = summary[27];
+    game->total = summary[28] | (summary[29] << 8);
+    for (c = 3; c >= 0; --c)
+	saved = (saved << 8) | summary[30 + c];
+    game->saved = (time_t) saved;
 }
 
 /*----------------------------------------------------------------------
@@ -192,21 +187,25 @@ static int save (Game *game)
     FILE *output; /* the output file */
     int r = 1, /* return value */
 	c; /* general counter */
+    unsigned char packed[SUMMARYSIZE]; /* the packed summary */
 
     /* open the output file */
     if (! (output = fopen (game->filename, "wb")))
 	return 0;
 
-    /* write the game header */
-    r = r && fwrite ("TDR100G", 8, 1, output);
+    /* write the game header and summary */
+    game->total = game->score->total (game->score, 12);
+    game->saved = time (NULL);
+    packsummary (game, packed);
+    r = r && fwrite ("TDR201G", 8, 1, output);
+    r = r && fwrite (packed, SUMMARYSIZE, 1, output);
     
     /* write the basic information */
     r = r &&
-	writestring (game->player, output) &&
-	writestring (game->levelpackfile, output) &&
 	writeint (&game->state, output) &&
 	writeint (&game->levelid, output) &&
-	writeint (&game->turnno, output);
+	writeint (&game->turnno, output) &&
+	writeint (&game->deployed, output);
 
     /* save the level progress */
     r = r && game->level->write (game->level, output);
@@ -237,6 +236,7 @@ static int load (Game *game, int summary)
 	c, /* general counter */
 	type; /* type read from file */
     char header[8]; /* header read from file */
+    unsigned char packed[SUMMARYSIZE]; /* the packed summary */
 
     /* open the input file */
     if (! (input = fopen (game->filename, "rb")))
@@ -245,11 +245,22 @@ static int load (Game *game, int summary)
     /* read the game header */
     r = r &&
 	fread (header, 8, 1, input) &&
-	! strncmp (header, "TDR100G", 8);
-
-    /* read the game settings */
-    r = r && readstring (game->player, input);
-    r = r && readstring (game->levelpackfile, input);
+	(! strncmp (header, "TDR201G", 8) ||
+	 ! strncmp (header, "TDR200G", 8) ||
+	 ! strncmp (header, "TDR100G", 8));
+
+    /* read the summary, which older games do not have in full */
+    if (r && strncmp (header, "TDR100G", 8)) {
+	r = r && fread (packed, SUMMARYSIZE, 1, input);
+	if (r)
+	    unpacksummary (game, packed);
+    } else {
+	r = r && readstring (game->player, input);
+	r = r && readstring (game->levelpackfile, input);
+	game->levelid = 0;
+	game->total = 0;
+	game->saved = 0;
+    }
 
     /* stop here if only the summary is needed */
     if (summary) {
@@ -262,6 +273,11 @@ static int load (Game *game, int summary)
     r = r && readint (&game->levelid, input);
     r = r && readint (&game->turnno, input);
 
+    /* only newer games note whether robots were just deployed */
+    game->deployed = 0;
+    if (! strncmp (header, "TDR201G", 8))
+	r = r && readint (&game->deployed, input);
+
     /* load in the level pack and current level state */
     if (r) {
 	if (game->levelpack)
@@ -322,6 +338,7 @@ static int turn (Game *game)
 
     /* advance turn */
     ++game->turnno;
+    game->deployed = 0;
 
     /* rotate library */
     temp = game->library[0];
@@ -337,7 +354,7 @@ static int turn (Game *game)
 		robot->ram[r] = 0;
 
     /* check for level complete */
-    if (checkcomplete (game)) {
+    if (simulate_complete (game->level)) {
 	game->score->scores[game->levelid] = game->turnno;
 	strcpy (game->score->player, game->player); /* again */
 	if (game->levelid == 11)
@@ -345,18 +362,16 @@ static int turn (Game *game)
 	else {
 	    game->turnno = 0;
 	    ++game->levelid;
-	    game->level->destroy (game->level);
 	    level = game->levelpack->levels[game->levelid];
-	    game->level = level->clone (level);
+	    game->level->copy (game->level, level);
 	    return game->state = STATE_COMPLETE;
 	}
     }
 
     /* check for level failed */
-    if (checkfailed (game)) {
-	game->level->destroy (game->level);
+    if (simulate_failed (game->level)) {
 	level = game->levelpack->levels[game->levelid];
-	game->level = level->clone (level);
+	game->level->copy (game->level, level);
 	return game->state = STATE_FAILED;
     }
 	
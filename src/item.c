@@ -19,10 +19,23 @@
 #include "item.h"
 #include "fatal.h"
 
+/*----------------------------------------------------------------------
+ * Constants.
+ */
+
+/** @const POOLSIZE The number of destroyed items kept for reuse. */
+#define POOLSIZE 64
+
 /*----------------------------------------------------------------------
  * Data Definitions.
  */
 
+/** @var pool Destroyed items kept for reuse. */
+static Item *pool[POOLSIZE];
+
+/** @var pooled The number of items in the pool. */
+static int pooled = 0;
+
 /*----------------------------------------------------------------------
  * Public Method Function Definitions.
  */
@@ -33,7 +46,10 @@
  */
 static void destroy (Item *item)
 {
-    free (item);
+    if (pooled < POOLSIZE)
+	pool[pooled++] = item;
+    else
+	free (item);
 }
 
 /**
@@ -63,8 +79,10 @@ Item *new_Item (int type)
 {
     Item *item; /* the new item */
 
-    /* reserve memory for item */
-    if (! (item = malloc (sizeof (Item))))
+    /* reuse a destroyed item or reserve memory for a new one */
+    if (pooled)
+	item = pool[--pooled];
+    else if (! (item = malloc (sizeof (Item))))
 	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
 
     /* initialise attributes */
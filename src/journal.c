@@ -0,0 +1,273 @@
+/*======================================================================
+ * Team Droid: Jam Edition
+ * A programming puzzle game with cute robots.
+ *
+ * Copyright (C) Damian Gareth Walker, 2022.
+ * Replay Journal Module.
+ */
+
+/*----------------------------------------------------------------------
+ * Headers
+ */
+
+/* ANSI C headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* project-specific headers */
+#include "journal.h"
+#include "fatal.h"
+#include "utils.h"
+
+/*----------------------------------------------------------------------
+ * Level 1 Function Definitions.
+ */
+
+/**
+ * Write a turn to an already open output file.
+ * @param  turn   The turn to write.
+ * @param  output The output file handle.
+ * @return        1 if successful, 0 on failure.
+ */
+static int writeturn (JournalTurn *turn, FILE *output)
+{
+    int r = 1, /* return value */
+	c, /* general counter */
+	s, /* RAM slot counter */
+	byte; /* a byte of the hash */
+
+    /* write the turn information and library */
+    r = r &&
+	writeint (&turn->levelid, output) &&
+	writeint (&turn->turnno, output) &&
+	writeint (&turn->deployed, output);
+    for (c = 0; c < 12; ++c)
+	r = r && writeint (&turn->library[c], output);
+
+    /* write the robots in priority order */
+    r = r && writeint (&turn->robotcount, output);
+    for (c = 0; c < turn->robotcount; ++c) {
+	r = r &&
+	    writeint (&turn->types[c], output) &&
+	    writeint (&turn->locations[c], output) &&
+	    writeint (&turn->facings[c], output);
+	for (s = 0; s < 8; ++s)
+	    r = r && writeint (&turn->ram[c][s], output);
+    }
+
+    /* write the hash of the outcome */
+    for (c = 0; c < 4; ++c) {
+	byte = (int) ((turn->hash >> (8 * c)) & 0xff);
+	r = r && writeint (&byte, output);
+    }
+
+    /* return the result */
+    return r;
+}
+
+/**
+ * Read a turn from an already open input file.
+ * @param  turn  The turn to read into.
+ * @param  input The input file handle.
+ * @return       1 if successful, 0 on failure.
+ */
+static int readturn (JournalTurn *turn, FILE *input)
+{
+    int r = 1, /* return value */
+	c, /* general counter */
+	s, /* RAM slot counter */
+	byte; /* a byte of the hash */
+
+    /* read the turn information and library */
+    r = r &&
+	readint (&turn->levelid, input) &&
+	readint (&turn->turnno, input) &&
+	readint (&turn->deployed, input);
+    for (c = 0; c < 12; ++c)
+	r = r && readint (&turn->library[c], input);
+
+    /* read the robots in priority order */
+    r = r &&
+	readint (&turn->robotcount, input) &&
+	turn->robotcount <= JOURNAL_MAXROBOTS;
+    for (c = 0; r && c < turn->robotcount; ++c) {
+	r = r &&
+	    readint (&turn->types[c], input) &&
+	    readint (&turn->locations[c], input) &&
+	    readint (&turn->facings[c], input);
+	for (s = 0; s < 8; ++s)
+	    r = r && readint (&turn->ram[c][s], input);
+    }
+
+    /* read the hash of the outcome */
+    turn->hash = 0;
+    for (c = 0; c < 4; ++c) {
+	r = r && readint (&byte, input);
+	turn->hash |= (unsigned long) byte << (8 * c);
+    }
+
+    /* return the result */
+    return r;
+}
+
+/*----------------------------------------------------------------------
+ * Public Method Function Definitions.
+ */
+
+/**
+ * Destroy the journal when it is no longer needed.
+ * @param journal The journal to destroy.
+ */
+static void destroy (Journal *journal)
+{
+    if (journal) {
+	if (journal->input)
+	    fclose (journal->input);
+	free (journal);
+    }
+}
+
+/**
+ * Set the journal filename to match a game filename.
+ * @param journal  The journal.
+ * @param gamefile The filename of the game.
+ */
+static void setgame (Journal *journal, char *gamefile)
+{
+    char *ext; /* pointer to filename extension */
+    strcpy (journal->filename, gamefile);
+    if ((ext = strchr (journal->filename, '.')))
+	*ext = '\0';
+    strcat (journal->filename, ".jnl");
+}
+
+/**
+ * Start a new journal, replacing any old one.
+ * @param  journal The journal to create.
+ * @return         1 if successful, 0 on failure.
+ */
+static int create (Journal *journal)
+{
+    FILE *output; /* the output file */
+    int r = 1; /* return value */
+
+    /* open the output file */
+    if (! (output = fopen (journal->filename, "wb")))
+	return 0;
+
+    /* write the header and level pack name */
+    r = r &&
+	fwrite ("TDR101J", 8, 1, output) &&
+	writestring (journal->levelpackfile, output);
+
+    /* close the output file and return */
+    fclose (output);
+    return r;
+}
+
+/**
+ * Add a turn to the end of the journal, creating it if necessary.
+ * @param  journal The journal.
+ * @param  turn    The turn to add.
+ * @return         1 if successful, 0 on failure.
+ */
+static int append (Journal *journal, JournalTurn *turn)
+{
+    FILE *output; /* the output file */
+    int r = 1; /* return value */
+
+    /* games saved before journals existed will need a new one */
+    if ((output = fopen (journal->filename, "rb")))
+	fclose (output);
+    else if (! create (journal))
+	return 0;
+
+    /* add the turn to the end of the file */
+    if (! (output = fopen (journal->filename, "ab")))
+	return 0;
+    r = r && writeturn (turn, output);
+    fclose (output);
+    return r;
+}
+
+/**
+ * Open the journal for reading and read its header.
+ * @param  journal The journal.
+ * @return         1 if successful, 0 on failure.
+ */
+static int open (Journal *journal)
+{
+    char header[8]; /* header read from file */
+
+    /* open the input file */
+    if (! (journal->input = fopen (journal->filename, "rb")))
+	return 0;
+
+    /* check the header and read the level pack name */
+    if (fread (header, 8, 1, journal->input) &&
+	! strcmp (header, "TDR101J") &&
+	readstring (journal->levelpackfile, journal->input))
+	return 1;
+
+    /* close the file if the header was invalid */
+    fclose (journal->input);
+    journal->input = NULL;
+    return 0;
+}
+
+/**
+ * Read the next turn from an open journal.
+ * @param  journal The journal.
+ * @param  turn    The turn to read into.
+ * @return         1 if successful, 0 at the end of the journal.
+ */
+static int read (Journal *journal, JournalTurn *turn)
+{
+    return journal->input && readturn (turn, journal->input);
+}
+
+/**
+ * Close a journal that was opened for reading.
+ * @param journal The journal.
+ */
+static void close (Journal *journal)
+{
+    if (journal->input)
+	fclose (journal->input);
+    journal->input = NULL;
+}
+
+/*----------------------------------------------------------------------
+ * Top Level Function Definitions.
+ */
+
+/**
+ * Construct a new journal.
+ * @return The new journal.
+ */
+Journal *new_Journal (void)
+{
+    Journal *journal; /* the new journal */
+
+    /* reserve memory for the journal */
+    if (! (journal = malloc (sizeof (Journal))))
+	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+
+    /* initialise the methods */
+    journal->destroy = destroy;
+    journal->setgame = setgame;
+    journal->create = create;
+    journal->append = append;
+    journal->open = open;
+    journal->read = read;
+    journal->close = close;
+
+    /* initialise the attributes */
+    *journal->filename = '\0';
+    *journal->levelpackfile = '\0';
+    journal->input = NULL;
+
+    /* return the new journal */
+    return journal;
+}
@@ -24,10 +24,198 @@
 #include "utils.h"
 
 
+/*----------------------------------------------------------------------
+ * Constants.
+ */
+
+/** @const PACKEDSIZE The size of a packed level without its robots. */
+#define PACKEDSIZE 194
+
+/** @const PACKEDROBOTSIZE The size of a packed robot with its location. */
+#define PACKEDROBOTSIZE (1 + ROBOT_PACKEDSIZE)
+
+/** @const SNAPSHOTROBOTSIZE The size of a robot in a level snapshot. */
+#define SNAPSHOTROBOTSIZE (2 + ROBOT_PACKEDSIZE)
+
 /*----------------------------------------------------------------------
  * Data Definitions.
  */
 
+/*----------------------------------------------------------------------
+ * Level 2 Function Definitions.
+ */
+
+/**
+ * Return the nearest other teleporter to a location.
+ * @param  level    The level to scan.
+ * @param  location The origin location.
+ * @return          The destination location.
+ */
+static int nearestteleport (Level *level, int location)
+{
+    int c, /* cell counter */
+	x, /* origin x coordinate */
+	y, /* origin y coordinate */
+	dest, /* destination cell */
+	nearest = 0, /* distance to the nearest teleport */
+	dist; /* distance to the scanned cell */
+    unsigned int row = 0; /* teleporters left in the current row */
+
+    /* dest defaults to current square */
+    dest = location;
+    x = location % 16;
+    y = location / 16;
+
+    /* scan through the teleporter bitboard for other teleports */
+    for (c = 0; c < 192; ++c) {
+
+	/* skip rows with no teleports left, and the start cell */
+	if (c % 16 == 0)
+	    row = level->cellmasks[CELL_TELEPORTER][c / 16];
+	if (! row) {
+	    c |= 15;
+	    continue;
+	}
+	if (! (row & LEVEL_BIT (c)))
+	    continue;
+	row &= ~LEVEL_BIT (c);
+	if (c == location)
+	    continue;
+
+	/* find distance between this teleport and us */
+	dist = abs (c % 16 - x);
+	if (abs (c / 16 - y) > dist)
+	    dist = abs (c / 16 - y);
+
+	/* set destination if it is closest found */
+	if (dist < nearest || nearest == 0) {
+	    dest = c;
+	    nearest = dist;
+	}
+    }
+
+    /* return the destination */
+    return dest;
+}
+
+/*----------------------------------------------------------------------
+ * Level 1 Function Definitions.
+ */
+
+/**
+ * Add a location to the list of active cells, keeping map order.
+ * @param level    The level.
+ * @param location The location to add.
+ */
+static void addactive (Level *level, int location)
+{
+    int a; /* active cell counter */
+    for (a = level->activecount++;
+	 a > 0 && level->active[a - 1] > location;
+	 --a)
+	level->active[a] = level->active[a - 1];
+    level->active[a] = location;
+}
+
+/**
+ * Remove a location from the list of active cells.
+ * @param level    The level.
+ * @param location The location to remove.
+ */
+static void removeactive (Level *level, int location)
+{
+    int a; /* active cell counter */
+    for (a = 0; a < level->activecount; ++a)
+	if (level->active[a] == location) {
+	    --level->activecount;
+	    memmove (&level->active[a], &level->active[a + 1],
+		     level->activecount - a);
+	    return;
+	}
+}
+
+/**
+ * Destroy the items and robots on the level, leaving the cells.
+ * @param level The level.
+ */
+static void releaseobjects (Level *level)
+{
+    int c; /* cell counter */
+    for (c = 0; c < 192; ++c) {
+	if (level->items[c]) {
+	    level->items[c]->destroy (level->items[c]);
+	    level->items[c] = NULL;
+	}
+	if (level->robots[c]) {
+	    level->robots[c]->destroy (level->robots[c]);
+	    level->robots[c] = NULL;
+	}
+    }
+}
+
+/**
+ * Fill in the teleport destination table.
+ * @param level The level.
+ */
+static void findteleports (Level *level)
+{
+    int c; /* cell counter */
+    for (c = 0; c < 192; ++c)
+	level->teleports[c] = level->cells[c] &&
+	    level->cells[c]->type == CELL_TELEPORTER
+	    ? nearestteleport (level, c)
+	    : c;
+    level->teleportsfound = 1;
+}
+
+/**
+ * Return the robot bitboard for a robot.
+ * @param  level The level.
+ * @param  robot The robot.
+ * @return       The player or guard bitboard.
+ */
+static unsigned int *robotmask (Level *level, Robot *robot)
+{
+    return robot->type == ROBOT_GUARD
+	? level->guardmask
+	: level->playermask;
+}
+
+/**
+ * Adjust the counters for a cell being added to or removed from a
+ * location. The cell must be in place when this is called.
+ * @param level    The level.
+ * @param location The location of the cell.
+ * @param change   1 if the cell is being added, -1 if removed.
+ */
+static void countcell (Level *level, int location, int change)
+{
+    if (level->cells[location]->type != CELL_READER)
+	return;
+    level->readers += change;
+    if (level->items[location] && level->items[location]->type == ITEM_CARD)
+	level->cardsread += change;
+}
+
+/**
+ * Adjust the counters for an item being added to or removed from a
+ * location. The item must be in place when this is called.
+ * @param level    The level.
+ * @param location The location of the item.
+ * @param change   1 if the item is being added, -1 if removed.
+ */
+static void countitem (Level *level, int location, int change)
+{
+    if (level->items[location]->type == ITEM_SPAWNER)
+	level->spawners += change;
+    else if (level->items[location]->type == ITEM_CARD) {
+	level->cards += change;
+	if (level->cells[location] &&
+	    level->cells[location]->type == CELL_READER)
+	    level->cardsread += change;
+    }
+}
+
 /*----------------------------------------------------------------------
  * Public Method Function Definitions.
  */
@@ -60,31 +248,169 @@ static void destroy (Level *level)
 static Level *clone (Level *level)
 {
     Level *newlevel; /* the level clone */
-    int c; /* general counter */
-
-    /* reserve memory for the new level */
     newlevel = new_Level ();
+    newlevel->copy (newlevel, level);
+    return newlevel;
+}
+
+/**
+ * Make the level an exact copy of another, reusing its memory.
+ * @param level  The level to overwrite.
+ * @param source The level to copy.
+ */
+static void copy (Level *level, Level *source)
+{
+    int c; /* cell counter */
+    Item *item; /* pointer to an item being reused */
+    Robot *robot; /* pointer to a robot being reused */
 
-    /* copy the cell information and contents */
+    /* copy the items and robots into those already on each square */
     for (c = 0; c < 192; ++c) {
-	newlevel->cells[c] = level->cells[c];
-	newlevel->items[c] = level->items[c]
-	    ? level->items[c]->clone (level->items[c])
-	    : NULL;
-	newlevel->robots[c] = level->robots[c]
-	    ? level->robots[c]->clone (level->robots[c])
-	    : NULL;
+	item = level->items[c];
+	if (source->items[c]) {
+	    if (! item)
+		item = new_Item (ITEM_NONE);
+	    *item = *source->items[c];
+	} else if (item) {
+	    item->destroy (item);
+	    item = NULL;
+	}
+	level->items[c] = item;
+	robot = level->robots[c];
+	if (source->robots[c]) {
+	    if (! robot)
+		robot = new_Robot (ROBOT_NONE);
+	    *robot = *source->robots[c];
+	} else if (robot) {
+	    robot->destroy (robot);
+	    robot = NULL;
+	}
+	level->robots[c] = robot;
     }
 
-    /* copy the level-wide data */
-    newlevel->readers = level->readers;
-    newlevel->cards = level->cards;
-    newlevel->spawners = level->spawners;
-    newlevel->robotcount = level->robotcount;
-    newlevel->turns = level->turns;
+    /* copy the cells, bitboards and counters */
+    memcpy (level->cells, source->cells, sizeof (level->cells));
+    memcpy (level->cellmasks, source->cellmasks, sizeof (level->cellmasks));
+    memcpy (level->itemmasks, source->itemmasks, sizeof (level->itemmasks));
+    memcpy (level->playermask, source->playermask,
+	    sizeof (level->playermask));
+    memcpy (level->guardmask, source->guardmask, sizeof (level->guardmask));
+    memcpy (level->teleports, source->teleports, sizeof (level->teleports));
+    level->teleportsfound = source->teleportsfound;
+    memcpy (level->active, source->active, sizeof (level->active));
+    level->activecount = source->activecount;
+    level->readers = source->readers;
+    level->cards = source->cards;
+    level->cardsread = source->cardsread;
+    level->spawners = source->spawners;
+    level->robotcount = source->robotcount;
+    level->turns = source->turns;
+}
 
-    /* return the new level */
-    return newlevel;
+/**
+ * Take a snapshot of the level in a single block of memory.
+ * @param  level    The level to take a snapshot of.
+ * @param  snapshot An old snapshot to reuse, or NULL.
+ * @return          The snapshot, to be freed with free().
+ */
+static LevelSnapshot *snapshot (Level *level, LevelSnapshot *snapshot)
+{
+    int c, /* cell counter */
+	robotcount = 0; /* number of robots */
+    size_t size; /* size of the snapshot */
+    unsigned char *p; /* pointer to a robot in the snapshot */
+    Robot *robot; /* pointer to a robot */
+
+    /* work out how much room the snapshot needs */
+    for (c = 0; c < 192; ++c)
+	if (level->robots[c])
+	    ++robotcount;
+    size = sizeof (LevelSnapshot) + robotcount * SNAPSHOTROBOTSIZE;
+
+    /* reuse the old snapshot if it is big enough */
+    if (! snapshot || snapshot->size < size) {
+	if (! (snapshot = realloc (snapshot, size)))
+	    fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+	snapshot->size = size;
+    }
+    snapshot->robots = (unsigned char *) (snapshot + 1);
+    snapshot->turns = level->turns;
+    snapshot->robotcount = robotcount;
+
+    /* record the squares and the robots on them */
+    p = snapshot->robots;
+    for (c = 0; c < 192; ++c) {
+	snapshot->squares[c] = (unsigned char)
+	    ((level->cells[c] ? level->cells[c]->type : 0)
+	     | (level->items[c] ? level->items[c]->type << 4 : 0));
+	snapshot->itemstatus[c] = (unsigned char)
+	    (level->items[c] ? level->items[c]->status : 0);
+	if ((robot = level->robots[c])) {
+	    p[0] = (unsigned char) c;
+	    p[1] = (unsigned char) robot->status;
+	    robot->pack (robot, p + 2);
+	    p += SNAPSHOTROBOTSIZE;
+	}
+    }
+
+    /* return the snapshot */
+    return snapshot;
+}
+
+/**
+ * Restore the level from a snapshot.
+ * @param level    The level to restore.
+ * @param snapshot The snapshot to restore it from.
+ */
+static void restore (Level *level, LevelSnapshot *snapshot)
+{
+    int c, /* cell counter */
+	type; /* cell or item type */
+    unsigned char *p, /* pointer to the next robot in the snapshot */
+	*end; /* pointer to the end of the robots */
+    Item *item; /* pointer to an item being reused */
+    Robot *robot; /* pointer to a robot being reused */
+
+    /* restore each square, reusing the item and robot already there */
+    p = snapshot->robots;
+    end = p + snapshot->robotcount * SNAPSHOTROBOTSIZE;
+    for (c = 0; c < 192; ++c) {
+
+	/* restore the cell if it has changed */
+	type = snapshot->squares[c] & 0xf;
+	if ((level->cells[c] ? level->cells[c]->type : 0) != type)
+	    level->setcell (level, c, type ? get_Cell (type) : NULL);
+
+	/* lift off any item and robot so the counters stay right */
+	if ((item = level->items[c]))
+	    level->setitem (level, c, NULL);
+	if ((robot = level->robots[c]))
+	    level->setrobot (level, c, NULL);
+
+	/* put back the item */
+	if ((type = snapshot->squares[c] >> 4)) {
+	    if (! item)
+		item = new_Item (type);
+	    item->type = type;
+	    item->status = snapshot->itemstatus[c];
+	    level->setitem (level, c, item);
+	} else if (item)
+	    item->destroy (item);
+
+	/* put back the robot */
+	if (p < end && *p == c) {
+	    if (! robot)
+		robot = new_Robot (ROBOT_NONE);
+	    robot->unpack (robot, p + 2);
+	    robot->x = c % 16;
+	    robot->y = c / 16;
+	    robot->status = p[1];
+	    level->setrobot (level, c, robot);
+	    p += SNAPSHOTROBOTSIZE;
+	} else if (robot)
+	    robot->destroy (robot);
+    }
+    level->turns = snapshot->turns;
 }
 
 /**
@@ -94,25 +420,22 @@ static Level *clone (Level *level)
 static void clear (Level *level)
 {
     int c; /* general counter */
-    Robot *robot; /* pointer to robot object */
-    Item *item; /* pointer to item object */
 
     /* clear out cell data */
-    for (c = 0; c < 192; ++c) {
+    releaseobjects (level);
+    for (c = 0; c < 192; ++c)
 	level->cells[c] = NULL;
-	if ((item = level->items[c])) {
-	    item->destroy (item);
-	    level->items[c] = NULL;
-	}
-	if ((robot = level->robots[c])) {
-	    robot->destroy (robot);
-	    level->robots[c] = NULL;
-	}
-    }
+    memset (level->cellmasks, 0, sizeof (level->cellmasks));
+    memset (level->itemmasks, 0, sizeof (level->itemmasks));
+    memset (level->playermask, 0, sizeof (level->playermask));
+    memset (level->guardmask, 0, sizeof (level->guardmask));
+    level->teleportsfound = 0;
+    level->activecount = 0;
 
     /* clear out level wide data */
     level->readers = 0;
     level->cards = 0;
+    level->cardsread = 0;
     level->spawners = 0;
     level->robotcount = 0;
     level->turns = 0;
@@ -173,49 +496,270 @@ static int read (Level *level, FILE *input)
     int c, /* general counter */
 	type, /* type ID read from the file */
 	r = 1; /* return code */
-
-    /* initialise cache attributes */
-    level->readers = 0;
-    level->cards = 0;
-    level->spawners = 0;
-    level->robotcount = 0;
+    Item *item; /* pointer to a new item */
+    Robot *robot; /* pointer to a new robot */
 
     /* read the cell types */
     for (c = 0; c < 192; ++c)
-	if ((r = r && readint (&type, input)) && type) {
-	    level->cells[c] = get_Cell (type);
-	    if (type == CELL_READER)
-		++level->readers;
-	}
+	if ((r = r && readint (&type, input)) && type)
+	    level->setcell (level, c, get_Cell (type));
 
     /* read the items */
     for (c = 0; c < 192; ++c)
 	if ((r = r && readint (&type, input)) && type) {
-	    if (! (level->items[c] = new_Item (type)))
+	    if (! (item = new_Item (type)))
 		fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
-	    if (type == ITEM_CARD)
-		++level->cards;
-	    else if (type == ITEM_SPAWNER)
-		++level->spawners;
+	    level->setitem (level, c, item);
 	}
 
     /* read the robots */
     for (c = 0; c < 192; ++c)
 	if ((r = r && readint (&type, input)) && type) {
-	    if (! (level->robots[c] = new_Robot (type)))
+	    if (! (robot = new_Robot (type)))
 		fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
-	    level->robots[c]->read (level->robots[c], input);
-	    if (type != ROBOT_GUARD)
-		++level->robotcount;
+	    robot->read (robot, input);
+	    level->setrobot (level, c, robot);
 	}
 
     /* read the number of turns taken */
     readint (&level->turns, input);
 
+    /* work out where the teleporters go */
+    findteleports (level);
+
     /* return success */
     return r;
 }
 
+/**
+ * Write the level to an already open file in packed form, with its
+ * length first so that it can be read in one go. Each map square is a
+ * byte, the cell type in the low nibble and any item in the high one,
+ * followed by the turns taken, the number of robots, and a record for
+ * each robot starting with its location.
+ * @param  level  The level to write.
+ * @param  output The output file handle.
+ * @return        1 if successful, 0 on failure.
+ */
+static int writepacked (Level *level, FILE *output)
+{
+    unsigned char *packed, /* the packed level */
+	*p; /* pointer to a packed robot */
+    int c, /* general counter */
+	robotcount = 0, /* number of robots on the level */
+	size, /* size of the packed level */
+	r; /* return code */
+    Robot *robot; /* pointer to a robot */
+
+    /* make room for the packed level */
+    for (c = 0; c < 192; ++c)
+	if (level->robots[c])
+	    ++robotcount;
+    size = PACKEDSIZE + PACKEDROBOTSIZE * robotcount;
+    if (! (packed = malloc (size)))
+	return 0;
+
+    /* pack the map squares, then the turns and robot count */
+    for (c = 0; c < 192; ++c)
+	packed[c] = (unsigned char)
+	    ((level->cells[c] ? level->cells[c]->type : 0)
+	     | (level->items[c] ? level->items[c]->type << 4 : 0));
+    packed[192] = (unsigned char) level->turns;
+    packed[193] = (unsigned char) robotcount;
+
+    /* pack the robots */
+    p = packed + PACKEDSIZE;
+    for (c = 0; c < 192; ++c)
+	if ((robot = level->robots[c])) {
+	    *p = (unsigned char) c;
+	    robot->pack (robot, p + 1);
+	    p += PACKEDROBOTSIZE;
+	}
+
+    /* write the length and then the packed level */
+    r = fputc (size & 0xff, output) != EOF
+	&& fputc (size >> 8, output) != EOF
+	&& fwrite (packed, size, 1, output);
+    free (packed);
+    return r;
+}
+
+/**
+ * Read a packed level from an already open file.
+ * @param  level The level to read.
+ * @param  input The input file handle.
+ * @return       1 if successful, 0 on failure.
+ */
+static int readpacked (Level *level, FILE *input)
+{
+    unsigned char length[2], /* the length as read from the file */
+	*packed, /* the packed level */
+	*p; /* pointer to a packed robot */
+    int c, /* general counter */
+	size, /* size of the packed level */
+	robotcount; /* number of robots on the level */
+    Item *item; /* pointer to a new item */
+    Robot *robot; /* pointer to a new robot */
+
+    /* read the whole level in one go */
+    if (! fread (length, 2, 1, input))
+	return 0;
+    size = length[0] | (length[1] << 8);
+    if (size < PACKEDSIZE || ! (packed = malloc (size)))
+	return 0;
+    if (! fread (packed, size, 1, input) ||
+	size != PACKEDSIZE + PACKEDROBOTSIZE * packed[193]) {
+	free (packed);
+	return 0;
+    }
+
+    /* unpack the map squares and the turns taken */
+    for (c = 0; c < 192; ++c) {
+	if (packed[c] & 0xf)
+	    level->setcell (level, c, get_Cell (packed[c] & 0xf));
+	if (packed[c] >> 4) {
+	    if (! (item = new_Item (packed[c] >> 4)))
+		fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+	    level->setitem (level, c, item);
+	}
+    }
+    level->turns = packed[192];
+
+    /* unpack the robots */
+    robotcount = packed[193];
+    for (c = 0, p = packed + PACKEDSIZE; c < robotcount;
+	 ++c, p += PACKEDROBOTSIZE) {
+	if (*p >= 192 || level->robots[*p])
+	    break;
+	if (! (robot = new_Robot (ROBOT_NONE)))
+	    fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+	robot->unpack (robot, p + 1);
+	robot->x = *p % 16;
+	robot->y = *p / 16;
+	level->setrobot (level, *p, robot);
+    }
+    free (packed);
+
+    /* work out where the teleporters go */
+    findteleports (level);
+
+    /* return success if every robot was placed */
+    return c == robotcount;
+}
+
+/**
+ * Set the cell type at a location.
+ * @param level    The level to change.
+ * @param location The location on the map.
+ * @param cell     The new cell type.
+ */
+static void setcell (Level *level, int location, Cell *cell)
+{
+    if ((level->cells[location] &&
+	 level->cells[location]->type == CELL_TELEPORTER) ||
+	(cell && cell->type == CELL_TELEPORTER))
+	level->teleportsfound = 0;
+    if (level->cells[location]) {
+	if (level->cells[location]->active)
+	    removeactive (level, location);
+	countcell (level, location, -1);
+	level->cellmasks[level->cells[location]->type][location / 16]
+	    &= ~LEVEL_BIT (location);
+    }
+    if ((level->cells[location] = cell)) {
+	level->cellmasks[cell->type][location / 16] |= LEVEL_BIT (location);
+	if (cell->active)
+	    addactive (level, location);
+	countcell (level, location, 1);
+    }
+}
+
+/**
+ * Put an item at a location, or remove one if item is NULL.
+ * @param level    The level to change.
+ * @param location The location on the map.
+ * @param item     The item to place, or NULL.
+ */
+static void setitem (Level *level, int location, Item *item)
+{
+    if (level->items[location]) {
+	countitem (level, location, -1);
+	level->itemmasks[level->items[location]->type][location / 16]
+	    &= ~LEVEL_BIT (location);
+    }
+    if ((level->items[location] = item)) {
+	level->itemmasks[item->type][location / 16] |= LEVEL_BIT (location);
+	countitem (level, location, 1);
+    }
+}
+
+/**
+ * Put a robot at a location, or remove one if robot is NULL.
+ * @param level    The level to change.
+ * @param location The location on the map.
+ * @param robot    The robot to place, or NULL.
+ */
+static void setrobot (Level *level, int location, Robot *robot)
+{
+    if (level->robots[location]) {
+	if (level->robots[location]->type != ROBOT_GUARD)
+	    --level->robotcount;
+	robotmask (level, level->robots[location])[location / 16]
+	    &= ~LEVEL_BIT (location);
+    }
+    if ((level->robots[location] = robot)) {
+	robotmask (level, robot)[location / 16] |= LEVEL_BIT (location);
+	if (robot->type != ROBOT_GUARD)
+	    ++level->robotcount;
+    }
+}
+
+/**
+ * Move an item to an empty location.
+ * @param level  The level to change.
+ * @param origin The location of the item.
+ * @param dest   The location to move it to.
+ */
+static void moveitem (Level *level, int origin, int dest)
+{
+    Item *item; /* the item to move */
+    if ((item = level->items[origin])) {
+	setitem (level, origin, NULL);
+	setitem (level, dest, item);
+    }
+}
+
+/**
+ * Move a robot, and any item it carries, to an empty location.
+ * @param level  The level to change.
+ * @param origin The location of the robot.
+ * @param dest   The location to move it to.
+ */
+static void moverobot (Level *level, int origin, int dest)
+{
+    Robot *robot; /* the robot to move */
+    if ((robot = level->robots[origin])) {
+	setrobot (level, origin, NULL);
+	setrobot (level, dest, robot);
+	robot->x = dest % 16;
+	robot->y = dest / 16;
+    }
+    moveitem (level, origin, dest);
+}
+
+/**
+ * Find where a teleporter sends things.
+ * @param  level    The level.
+ * @param  location The location of the teleporter.
+ * @return          The destination, or location if there is none.
+ */
+static int teleport (Level *level, int location)
+{
+    if (! level->teleportsfound)
+	findteleports (level);
+    return level->teleports[location];
+}
+
 /*----------------------------------------------------------------------
  * Top Level Function Definitions.
  */
@@ -239,8 +783,15 @@ Level *new_Level (void)
 	level->items[c] = NULL;
 	level->robots[c] = NULL;
     }
+    memset (level->cellmasks, 0, sizeof (level->cellmasks));
+    memset (level->itemmasks, 0, sizeof (level->itemmasks));
+    memset (level->playermask, 0, sizeof (level->playermask));
+    memset (level->guardmask, 0, sizeof (level->guardmask));
+    level->teleportsfound = 0;
+    level->activecount = 0;
     level->readers = 0;
     level->cards = 0;
+    level->cardsread = 0;
     level->spawners = 0;
     level->robotcount = 0;
     level->turns = 0;
@@ -248,9 +799,20 @@ Level *new_Level (void)
     /* initialise the methods */
     level->destroy = destroy;
     level->clone = clone;
+    level->copy = copy;
+    level->snapshot = snapshot;
+    level->restore = restore;
     level->clear = clear;
     level->write = write;
     level->read = read;
+    level->writepacked = writepacked;
+    level->readpacked = readpacked;
+    level->setcell = setcell;
+    level->setitem = setitem;
+    level->setrobot = setrobot;
+    level->moveitem = moveitem;
+    level->moverobot = moverobot;
+    level->teleport = teleport;
 
     /* return the new level */
     return level;
@@ -88,7 +88,7 @@ static int save (LevelPack *levelpack)
     /* open the output file and write the header */
     if (! (output = fopen (levelpack->filename, "wb")))
 	return 0;
-    r = r && fwrite ("TDR100L", 8, 1, output);
+    r = r && fwrite ("TDR200L", 8, 1, output);
 
     /* write the name */
     r = r && writestring (levelpack->name, output);
@@ -96,7 +96,7 @@ static int save (LevelPack *levelpack)
     /* write the levels */
     for (c = 0; c < 12; ++c) {
 	level = levelpack->levels[c];
-	r = r && level->write (level, output);
+	r = r && level->writepacked (level, output);
     }
 
     /* close the file and return */
@@ -153,7 +153,7 @@ static int load (LevelPack *levelpack, int summary)
     if (! (input = fopen (levelpack->filename, "rb")))
 	return 0;
     r = r && fread (header, 8, 1, input);
-    r = r && ! strcmp (header, "TDR100L");
+    r = r && (! strcmp (header, "TDR200L") || ! strcmp (header, "TDR100L"));
 
     /* read the name */
     r = r && readstring (levelpack->name, input);
@@ -164,10 +164,13 @@ static int load (LevelPack *levelpack, int summary)
 	return r;
     }
 
-    /* read the levels */
+    /* read the levels, packed unless the pack is in the old format */
     for (c = 0; c < 12; ++c) {
 	level = levelpack->levels[c];
-	r = r && level->read (level, input);
+	if (! strcmp (header, "TDR100L"))
+	    r = r && level->read (level, input);
+	else
+	    r = r && level->readpacked (level, input);
     }
 
     /* close the level pack file */
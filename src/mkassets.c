@@ -24,7 +24,7 @@
 #include "robot.h"
 #include "action.h"
 #include "fatal.h"
-
+#include "assets.h"
 
 /*----------------------------------------------------------------------
  * Data Definitions.
@@ -36,42 +36,45 @@ static FILE *output;
 /** @var scr The screen. */
 static Screen *scr;
 
-/**
- * var playerrobotnames
- * The name of the six player robots
- */
-static char *playerrobotnames[6] = {
-    "Strider",
-    "Bouncer",
-    "Soldier",
-    "Carrier",
-    "Thinker",
-    "Multibot"
-};
+/** @var offsets The offset of each section in the output file. */
+static long offsets[ASSETS_LAST];
 
-/**
- * var playerrobotstats
- * The stats of the six player robots
- */
-static int playerrobotstats[6][7] = {
-    {1, 5, 1, 0, 0, 1, ACTION_STEPFORWARD},
-    {2, 6, 0, 1, 0, 1, ACTION_LEAP},
-    {3, 6, 0, 0, 1, 1, ACTION_SHOOT},
-    {4, 7, 0, 0, 0, 1, ACTION_TAKE},
-    {5, 8, 0, 0, 0, 1, ACTION_NONE},
-    {6, 4, 1, 1, 1, 0, ACTION_NONE}
-};
+/** @var sizes The size of each section in the output file. */
+static long sizes[ASSETS_LAST];
 
-/**
- * var guardrobotstats
- * The stats of the guard robot.
- */
-static int guardrobotstats[7] = {7, 8, 1, 1, 1, 0, ACTION_NONE};
+/** @var section The section being written, or -1. */
+static int section = -1;
 
 /*----------------------------------------------------------------------
  * Level 3 Routines.
  */
 
+/**
+ * Write a little-endian number to the output file.
+ * @param value The value to write.
+ * @param bytes The number of bytes to write it in.
+ */
+static void writenumber (unsigned long value, int bytes)
+{
+    unsigned char c; /* byte to write */
+    while (bytes--) {
+	c = (unsigned char) (value & 0xff);
+	if (! fwrite (&c, 1, 1, output))
+	    fatalerror (FATAL_NODATA, __FILE__, __LINE__);
+	value >>= 8;
+    }
+}
+
+/**
+ * Finish the section being written, noting its size.
+ */
+static void endsection (void)
+{
+    if (section != -1)
+	sizes[section] = ftell (output) - offsets[section];
+    section = -1;
+}
+
 /**
  * Extract a sprite (a bitmap and mask pair) from the raw assets.
  * @param x The X coordinate of the pair in the raw assets.
@@ -103,6 +106,17 @@ void extracttile (int x, int y)
  * Level 2 Routines.
  */
 
+/**
+ * Start a new section of the output file.
+ * @param id The section to start.
+ */
+static void startsection (int id)
+{
+    endsection ();
+    section = id;
+    offsets[id] = ftell (output);
+}
+
 /**
  * Initialise the screen.
  */
@@ -345,34 +359,17 @@ static void close_screen (void)
 
 /**
  * Generate and save the data for a robot.
- * @param name The name of the robots.
- * @param stats A pointer to the stats array.
+ * @param type The robot type.
  */
-static void makerobotdata (char *name, int *stats)
+static void makerobotdata (int type)
 {
     Robot *robot; /* temporary robot object */
-
-    /* reserve memory for robot */
-    if (! (robot = new_Robot (stats[0])))
-	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
-
-    /* copy name */
-    strcpy (robot->name, name);
-
-    /* copy stats */
-    robot->type = stats[0];
-    robot->ramsize = stats[1];
-    robot->haswalker = stats[2];
-    robot->hasspring = stats[3];
-    robot->hasphaser = stats[4];
-    robot->hasinventory = stats[5];
-    robot->rom = stats[6];
-    memset (robot->ram, '\0', 8);
-    robot->x = 0xff;
-    robot->y = 0xff;
-
-    /* write the robot */
-    robot->write (robot, output);
+    unsigned char packed[ROBOT_PACKEDSIZE]; /* the packed robot */
+    robot = new_StandardRobot (type);
+    robot->pack (robot, packed);
+    if (! fwrite (packed, ROBOT_PACKEDSIZE, 1, output))
+	fatalerror (FATAL_NODATA, __FILE__, __LINE__);
+    robot->destroy (robot);
 }
 
 /*----------------------------------------------------------------------
@@ -380,14 +377,17 @@ static void makerobotdata (char *name, int *stats)
  */
 
 /**
- * Create the output file.
+ * Create the output file, leaving room for the table of contents.
  */
 void createoutputfile (void)
 {
-    if (! (output = fopen ("tdroid/tdroid.dat", "wb")))
+    int c; /* section counter */
+    if (! (output = fopen ("tdroid/" ASSETS_FILENAME, "wb")))
 	fatalerror (FATAL_NODATA, __FILE__, __LINE__);
-    if (! (fwrite ("TDR100D", 8, 1, output)))
+    if (! (fwrite (ASSETS_HEADER, 8, 1, output)))
 	fatalerror (FATAL_NODATA, __FILE__, __LINE__);
+    for (c = 0; c < ASSETS_LAST; ++c)
+	writenumber (0, ASSETS_ENTRYSIZE);
 }
 
 /**
@@ -398,10 +398,13 @@ void makegraphicalassets (void)
     int c; /* general purpose counter */
     initialise_screen ();
     loadrawassets (0);
+    startsection (ASSETS_LOGO);
     makelogo ();
     loadrawassets (2);
+    startsection (ASSETS_TITLE);
     maketitlescreen ();
     loadrawassets (0);
+    startsection (ASSETS_GRAPHICS);
     makemapborder ();
     for (c = 0; c < 3; ++c) {
 	if (c)
@@ -455,6 +458,7 @@ void makefontassets (void)
     if (! (fnt = fnt_read (input)))
 	fatalerror (FATAL_NODATA, __FILE__, __LINE__);
     fclose (input);
+    startsection (ASSETS_FONT);
     fnt_write (fnt, output);
     fnt_destroy (fnt);
 }
@@ -469,6 +473,7 @@ void makesoundassets (void)
     /* create the sound objects */
     if (! (effect = new_Effect ()))
 	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+    startsection (ASSETS_SOUND);
 
     /* robot deployment noise */
     effect->pattern = EFFECT_FALL;
@@ -561,16 +566,25 @@ void makesoundassets (void)
 void makedataassets (void)
 {
     int c; /* general purpose counter */
-    for (c = 0; c < 6; ++c)
-	makerobotdata (playerrobotnames[c], playerrobotstats[c]);
-    makerobotdata ("Guard", guardrobotstats);
+    startsection (ASSETS_ROBOTS);
+    for (c = 1; c <= 7; ++c)
+	makerobotdata (c);
 }
 
 /**
- * Close the output file.
+ * Fill in the table of contents and close the output file.
  */
 void closeoutputfile (void)
 {
+    int c; /* section counter */
+    endsection ();
+    fseek (output, 8, SEEK_SET);
+    for (c = 0; c < ASSETS_LAST; ++c) {
+	if (sizes[c] > 0xffff)
+	    fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
+	writenumber (offsets[c], 4);
+	writenumber (sizes[c], 2);
+    }
     fclose (output);
 }
 
@@ -22,6 +22,7 @@
 #include "item.h"
 #include "robot.h"
 #include "action.h"
+#include "solver.h"
 #include "fatal.h"
 
 
@@ -49,6 +50,15 @@ static FILE *input;
 /** @var filename is the base filename without extension. */
 static char *filename;
 
+/** @var solving is 1 if the levels are to be solved. */
+static int solving = 0;
+
+/** @var timelimit is the number of seconds to spend on each level. */
+static int timelimit = 60;
+
+/** @var maxstates is the number of states to remember for each level. */
+static long maxstates = 0;
+
 /** @var line is the number of the input line being processed */
 static int line = 0;
 
@@ -88,6 +98,16 @@ static char *actionnames[13] = {
     "shoot"
 };
 
+/** @var robotnames An array of the player robot names. */
+static char *robotnames[6] = {
+    "strider",
+    "bouncer",
+    "soldier",
+    "carrier",
+    "thinker",
+    "multibot"
+};
+
 /*----------------------------------------------------------------------
  * Level 3 Functions.
  */
@@ -260,12 +280,12 @@ static void processlevelmapline (void)
 	    case '*':
 	    case '+':
 	    case '$':
-		level->cells[x + 16 * y] = get_Cell (t + 1);
+		level->setcell (level, x + 16 * y, get_Cell (t + 1));
 		break;
 
 	    case 'G': /* guard robot characters */
-		level->cells[x + 16 * y] = get_Cell (CELL_FLOOR);
-		level->robots[x + 16 * y] = new_Robot (ROBOT_GUARD);
+		level->setcell (level, x + 16 * y, get_Cell (CELL_FLOOR));
+		level->setrobot (level, x + 16 * y, new_Robot (ROBOT_GUARD));
 		break;
 
 	    case 'R': /* items and pseudo-items */
@@ -274,8 +294,8 @@ static void processlevelmapline (void)
 	    case 'S':
 	    case 'P':
 	    case 'C':
-		level->cells[x + 16 * y] = get_Cell (CELL_FLOOR);
-		level->items[x + 16 * y] = new_Item (t - 12);
+		level->setcell (level, x + 16 * y, get_Cell (CELL_FLOOR));
+		level->setitem (level, x + 16 * y, new_Item (t - 12));
 		break;
 	    }
 	}
@@ -324,6 +344,59 @@ static void processlevelguardline (void)
 	robot->ram[c] = actionlookup ();
 }
 
+/**
+ * Write the result of solving a level to the solution file.
+ * @param output is the solution file.
+ * @param solver is the solver holding the result.
+ * @param id is the level number.
+ */
+static void writesolution (FILE *output, Solver *solver, int id)
+{
+    int s, /* spawner counter */
+	t, /* turn counter */
+	type, /* robot type */
+	m, /* move counter */
+	length; /* program length without trailing waits */
+
+    /* write the level header and the result */
+    fprintf (output, "\nlevel %d\n", id);
+    if (solver->result == SOLVER_UNSOLVABLE) {
+	fprintf (output, "unsolvable\n");
+	return;
+    } else if (solver->result == SOLVER_TOOBIG) {
+	fprintf (output, "unknown 0 ; too many spawners or robots\n");
+	return;
+    } else if (solver->result == SOLVER_GAVEUP) {
+	fprintf (output, "unknown %d ; no solution in %d turns, %ld states"
+		 ", %s limit reached\n", solver->turns, solver->turns,
+		 solver->states,
+		 solver->turns < solver->maxturns ? "time" : "turn");
+	return;
+    }
+    fprintf (output, "par %d ; %ld states\n", solver->turns,
+	     solver->states);
+
+    /* write the deployment */
+    for (s = 0; s < solver->spawnercount; ++s)
+	if ((type = solver->deployment[s]))
+	    fprintf (output, "deploy %s %d %d\n", robotnames[type - 1],
+		     solver->spawners[s] % 16, solver->spawners[s] / 16);
+
+    /* write the program for each robot on each turn */
+    for (t = 0; t < solver->turns; ++t)
+	for (s = 0; s < solver->spawnercount; ++s) {
+	    if (! (type = solver->deployment[s]))
+		continue;
+	    for (length = 8; length > 0 &&
+		     ! solver->programs[t][type - 1][length - 1]; --length);
+	    fprintf (output, "program %d %s", t + 1, robotnames[type - 1]);
+	    for (m = 0; m < length; ++m)
+		fprintf (output, " %s",
+			 actionnames[solver->programs[t][type - 1][m]]);
+	    fprintf (output, length ? "\n" : " wait\n");
+	}
+}
+
 /*----------------------------------------------------------------------
  * Level 1 Functions.
  */
@@ -335,9 +408,30 @@ static void processlevelguardline (void)
  */
 static void initialiseoptions (int argc, char **argv)
 {
-    if (argc != 2)
+    int c; /* argument counter */
+
+    /* scan through the options */
+    for (c = 1; c < argc - 1; ++c)
+	if (! strcmp (argv[c], "-s") || ! strcmp (argv[c], "--solve"))
+	    solving = 1;
+	else if (! strcmp (argv[c], "-t") && c < argc - 2)
+	    timelimit = atoi (argv[++c]);
+	else if (! strcmp (argv[c], "-m") && c < argc - 2)
+	    maxstates = atol (argv[++c]);
+	else
+	    fatalerror (FATAL_COMMAND_LINE, __FILE__, __LINE__);
+
+    /* the last argument is the level pack name */
+    if (c != argc - 1 || *argv[c] == '-')
 	fatalerror (FATAL_COMMAND_LINE, __FILE__, __LINE__);
-    filename = argv[1];
+    filename = argv[c];
+
+    /* the solver can remember only so many states */
+    if (maxstates > SOLVER_MAXSTATES) {
+	printf ("Warning: -m %ld reduced to %ld, the most this build"
+		" can remember.\n", maxstates, SOLVER_MAXSTATES);
+	maxstates = SOLVER_MAXSTATES;
+    }
 }
 
 /**
@@ -441,6 +535,60 @@ static void savelevelpack (void)
 	fatalerror (FATAL_NODATA, __FILE__, __LINE__);
 }
 
+/**
+ * Solve the levels and write the results beside the level pack.
+ */
+static void solvelevelpack (void)
+{
+    FILE *output; /* the solution file */
+    char *outputfilename; /* the solution filename */
+    Solver *solver; /* the level solver */
+    int l; /* level counter */
+
+    /* open the solution file */
+    if (! (outputfilename = malloc (strlen (filename) + 5)))
+	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+    sprintf (outputfilename, "%s.sol", filename);
+    if (! (output = fopen (outputfilename, "w")))
+	fatalerror (FATAL_NODATA, __FILE__, __LINE__);
+    free (outputfilename);
+
+    /* write the header, noting that any library order is allowed */
+    solver = new_Solver ();
+    solver->timelimit = timelimit;
+    if (maxstates)
+	solver->maxstates = maxstates;
+    fprintf (output, "; Solutions for %s\n;\n", levelpack->name);
+    fprintf (output, "; Robots may use any library action on any turn, as\n"
+	"; the library is shuffled for each level. A par is the fewest\n"
+	"; turns with the kindest order; unsolvable holds for any order.\n");
+
+    /* solve each level in turn */
+    for (l = 0; l < 12; ++l) {
+	if (! levelpack->levels[l])
+	    continue;
+	solver->solve (solver, levelpack->levels[l]);
+	writesolution (output, solver, l + 1);
+	if (solver->result == SOLVER_SOLVED)
+	    printf ("Level %d: par %d.\n", l + 1, solver->turns);
+	else if (solver->result == SOLVER_UNSOLVABLE)
+	    printf ("Level %d: unsolvable.\n", l + 1);
+	else if (solver->result == SOLVER_TOOBIG)
+	    printf ("Level %d: too many spawners or robots to solve.\n",
+		    l + 1);
+	else
+	    printf ("Level %d: no solution in %d turns.\n", l + 1,
+		    solver->turns);
+	if (solver->forgotten)
+	    printf ("Warning: level %d forgot %ld states; raise -m to"
+		    " search faster.\n", l + 1, solver->forgotten);
+    }
+
+    /* clean up */
+    solver->destroy (solver);
+    fclose (output);
+}
+
 /*----------------------------------------------------------------------
  * Top Level Function.
  */
@@ -464,6 +612,8 @@ int main (int argc, char **argv)
 
     /* complete and save the levelpack */
     savelevelpack ();
+    if (solving)
+	solvelevelpack ();
 
     /* clean up */
     levelpack->destroy (levelpack);
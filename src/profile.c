@@ -0,0 +1,325 @@
+/*======================================================================
+ * Team Droid: Jam Edition
+ * A programming puzzle game with cute robots.
+ *
+ * Copyright (C) Damian Gareth Walker, 2022.
+ * Profiling Module.
+ */
+
+/*----------------------------------------------------------------------
+ * Headers
+ */
+
+/* ANSI C headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+
+/* compiler specific headers */
+#include <conio.h>
+#include <i86.h>
+
+/* project-specific headers */
+#include "profile.h"
+
+/* this module makes the allocations that it counts */
+#undef malloc
+#undef calloc
+#undef realloc
+
+/*----------------------------------------------------------------------
+ * Constants.
+ */
+
+/** @const BUCKETS The number of histogram buckets for each timer. */
+#define BUCKETS 9
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/**
+ * @struct profiletimer
+ * The counts and times gathered for one thing being profiled.
+ */
+typedef struct profiletimer ProfileTimer;
+struct profiletimer {
+
+    /** @var started The clock reading when timing started. */
+    unsigned long started;
+
+    /** @var count The number of times the thing was timed. */
+    unsigned long count;
+
+    /** @var total The total time taken in microseconds. */
+    unsigned long total;
+
+    /** @var longest The longest time taken in microseconds. */
+    unsigned long longest;
+
+    /** @var histogram The number of times in each range. */
+    unsigned int histogram[BUCKETS];
+
+};
+
+/** @var timers The counts and times for each thing profiled. */
+static ProfileTimer timers[PROFILE_LAST];
+
+/** @var names The name of each thing profiled, for the log. */
+static char *names[PROFILE_LAST] = {
+    "sprint",
+    "sprint effects",
+    "general",
+    "shoot",
+    "effects",
+    "rules",
+    "showlevelmap",
+    "update",
+    "blit",
+    "sound",
+    "delay"
+};
+
+/** @var bucketnames The heading for each histogram bucket. */
+static char *bucketnames[BUCKETS] = {
+    "<64us", "<256us", "<1ms", "<4ms", "<16ms",
+    "<64ms", "<256ms", "<1s", ">=1s"
+};
+
+/** @var output The log file, or NULL if it is not open. */
+static FILE *output = NULL;
+
+/** @var biosticks The BIOS count of timer ticks since midnight. */
+static unsigned long *biosticks;
+
+/** @var allocations The number of heap allocations counted. */
+static unsigned long allocations = 0;
+
+/*----------------------------------------------------------------------
+ * Level 1 Function Definitions.
+ */
+
+/**
+ * Read the clock, in units of 1/1193182 of a second. The BIOS tick
+ * count gives the high word and the timer chip the low word.
+ * @return The clock reading.
+ */
+static unsigned long readclock (void)
+{
+    unsigned long ticks; /* BIOS ticks since midnight */
+    unsigned int count, /* timer chip countdown */
+	pending; /* 1 if a tick has not been counted yet */
+
+    /* read the tick count and latch the timer together */
+    _disable ();
+    outp (0x43, 0x00);
+    count = inp (0x40);
+    count |= inp (0x40) << 8;
+    ticks = *biosticks;
+    outp (0x20, 0x0a);
+    pending = inp (0x20) & 1;
+    _enable ();
+
+    /* a tick that has wrapped the timer but not been counted */
+    if (pending && count > 0x8000)
+	++ticks;
+    return (ticks << 16) + (unsigned int) (0 - count);
+}
+
+/**
+ * Find the histogram bucket for a time.
+ * @param  micros The time in microseconds.
+ * @return        The bucket number.
+ */
+static int bucket (unsigned long micros)
+{
+    int b; /* bucket counter */
+    unsigned long limit = 64; /* upper limit of the bucket */
+    for (b = 0; b < BUCKETS - 1; ++b, limit *= 4)
+	if (micros < limit)
+	    return b;
+    return BUCKETS - 1;
+}
+
+/**
+ * Reset the counts and times.
+ */
+static void reset (void)
+{
+    memset (timers, 0, sizeof (timers));
+}
+
+/*----------------------------------------------------------------------
+ * Top Level Function Definitions.
+ */
+
+/**
+ * Start profiling, setting up the clock and opening the log file.
+ * @param filename The name of the log file.
+ */
+void profile_open (char *filename)
+{
+    /* run timer 0 as a rate generator so its count is reliable */
+    biosticks = MK_FP (0x40, 0x6c);
+    _disable ();
+    outp (0x43, 0x34);
+    outp (0x40, 0);
+    outp (0x40, 0);
+    _enable ();
+
+    /* open the log file and start counting */
+    output = fopen (filename, "w");
+    reset ();
+}
+
+/**
+ * Stop profiling, restoring the clock and closing the log file.
+ */
+void profile_close (void)
+{
+    /* put timer 0 back into its usual square wave mode */
+    _disable ();
+    outp (0x43, 0x36);
+    outp (0x40, 0);
+    outp (0x40, 0);
+    _enable ();
+
+    /* close the log file */
+    if (output)
+	fclose (output);
+    output = NULL;
+}
+
+/**
+ * Start timing something.
+ * @param id The thing to time.
+ */
+void profile_start (int id)
+{
+    if (output)
+	timers[id].started = readclock ();
+}
+
+/**
+ * Stop timing something, adding the time taken to its totals.
+ * @param id The thing being timed.
+ */
+void profile_stop (int id)
+{
+    ProfileTimer *timer; /* the timer to update */
+    unsigned long elapsed; /* the time taken in clock units */
+
+    /* convert the time taken to microseconds */
+    if (! output)
+	return;
+    timer = &timers[id];
+    elapsed = readclock () - timer->started;
+    elapsed = elapsed - elapsed / 6 + elapsed / 200;
+
+    /* add it to the totals */
+    ++timer->count;
+    timer->total += elapsed;
+    if (elapsed > timer->longest)
+	timer->longest = elapsed;
+    ++timer->histogram[bucket (elapsed)];
+}
+
+/**
+ * Write the counts, times and histograms gathered since the last
+ * report to the log file, then reset them.
+ * @param levelid The level being played.
+ * @param turnno  The turn being played.
+ */
+void profile_report (int levelid, int turnno)
+{
+    int id, /* profile identifier */
+	b; /* bucket counter */
+    ProfileTimer *timer; /* the timer to report */
+
+    /* write the headings */
+    if (! output)
+	return;
+    fprintf (output, "Level %d, turn %d\n%-14s %6s %9s %8s",
+	     levelid + 1, turnno + 1, "", "count", "total ms", "max ms");
+    for (b = 0; b < BUCKETS; ++b)
+	fprintf (output, " %6s", bucketnames[b]);
+    fprintf (output, "\n");
+
+    /* write a line for everything that happened */
+    for (id = 0; id < PROFILE_LAST; ++id) {
+	timer = &timers[id];
+	if (! timer->count)
+	    continue;
+	fprintf (output, "%-14s %6lu %9lu %8lu", names[id],
+		 timer->count, timer->total / 1000, timer->longest / 1000);
+	for (b = 0; b < BUCKETS; ++b)
+	    fprintf (output, " %6u", timer->histogram[b]);
+	fprintf (output, "\n");
+    }
+
+    /* make sure the report is written in case of a crash */
+    fprintf (output, "\n");
+    fflush (output);
+    reset ();
+}
+
+/**
+ * Allocate memory, counting the allocation.
+ * @param  size The number of bytes to allocate.
+ * @return      The memory allocated, or NULL on failure.
+ */
+void *profile_malloc (size_t size)
+{
+    ++allocations;
+    return malloc (size);
+}
+
+/**
+ * Allocate cleared memory, counting the allocation.
+ * @param  count The number of items to allocate.
+ * @param  size  The size of each item in bytes.
+ * @return       The memory allocated, or NULL on failure.
+ */
+void *profile_calloc (size_t count, size_t size)
+{
+    ++allocations;
+    return calloc (count, size);
+}
+
+/**
+ * Resize allocated memory, counting the allocation.
+ * @param  block The memory to resize, or NULL.
+ * @param  size  The new size in bytes.
+ * @return       The memory allocated, or NULL on failure.
+ */
+void *profile_realloc (void *block, size_t size)
+{
+    ++allocations;
+    return realloc (block, size);
+}
+
+/**
+ * Find out how many heap allocations have been counted.
+ * @return The number of allocations.
+ */
+unsigned long profile_allocations (void)
+{
+    return allocations;
+}
+
+/**
+ * Count the blocks in use on the heap, which include those allocated
+ * by the libraries.
+ * @return The number of blocks in use.
+ */
+unsigned int profile_heapblocks (void)
+{
+    struct _heapinfo entry; /* the heap entry being looked at */
+    unsigned int blocks = 0; /* the number of blocks in use */
+    entry._pentry = NULL;
+    while (_heapwalk (&entry) == _HEAPOK)
+	if (entry._useflag == _USEDENTRY)
+	    ++blocks;
+    return blocks;
+}
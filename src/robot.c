@@ -21,6 +21,49 @@
 #include "utils.h"
 
 
+/*----------------------------------------------------------------------
+ * Constants.
+ */
+
+/** @const POOLSIZE The number of destroyed robots kept for reuse. */
+#define POOLSIZE 32
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/** @var pool Destroyed robots kept for reuse. */
+static Robot *pool[POOLSIZE];
+
+/** @var pooled The number of robots in the pool. */
+static int pooled = 0;
+
+/** @var robotnames The names of the standard robots. */
+static char *robotnames[7] = {
+    "Strider",
+    "Bouncer",
+    "Soldier",
+    "Carrier",
+    "Thinker",
+    "Multibot",
+    "Guard"
+};
+
+/**
+ * @var robotstats
+ * The stats of the standard robots: RAM size, walker, spring,
+ * phaser, inventory and ROM action.
+ */
+static int robotstats[7][6] = {
+    {5, 1, 0, 0, 1, ACTION_STEPFORWARD}, /* strider */
+    {6, 0, 1, 0, 1, ACTION_LEAP}, /* bouncer */
+    {6, 0, 0, 1, 1, ACTION_SHOOT}, /* soldier */
+    {7, 0, 0, 0, 1, ACTION_TAKE}, /* carrier */
+    {8, 0, 0, 0, 1, ACTION_NONE}, /* thinker */
+    {4, 1, 1, 1, 0, ACTION_NONE}, /* multibot */
+    {8, 1, 1, 1, 0, ACTION_NONE} /* guard */
+};
+
 /*----------------------------------------------------------------------
  * Level 1 Function Definitions.
  */
@@ -58,7 +101,11 @@ static void initialiseattributes (Robot *robot)
  */
 static void destroy (Robot *robot)
 {
-    if (robot)
+    if (! robot)
+	return;
+    else if (pooled < POOLSIZE)
+	pool[pooled++] = robot;
+    else
 	free (robot);
 }
 
@@ -175,6 +222,63 @@ static int read (Robot *robot, FILE *input)
     return r;
 }
 
+/**
+ * Pack the robot into ROBOT_PACKEDSIZE bytes of memory. Its location
+ * is not included.
+ * @param robot  The robot to pack.
+ * @param packed The memory to pack it into.
+ */
+static void pack (Robot *robot, unsigned char *packed)
+{
+    int c; /* generic counter */
+
+    /* pack the static attributes, the equipment as flags */
+    packed[0] = (unsigned char) robot->type;
+    packed[1] = (unsigned char) robot->ramsize;
+    packed[2] = (unsigned char) ((robot->haswalker ? 1 : 0)
+				 | (robot->hasspring ? 2 : 0)
+				 | (robot->hasphaser ? 4 : 0)
+				 | (robot->hasinventory ? 8 : 0));
+    packed[3] = (unsigned char) robot->rom;
+
+    /* pack the changing attributes */
+    packed[4] = (unsigned char) robot->facing;
+    for (c = 0; c < 8; ++c)
+	packed[5 + c] = (unsigned char)
+	    (c < robot->ramsize ? robot->ram[c] : 0);
+
+    /* pack the name, padded with nulls */
+    strncpy ((char *) packed + 13, robot->name, 8);
+}
+
+/**
+ * Unpack the robot from memory.
+ * @param robot  The robot to unpack.
+ * @param packed The memory to unpack it from.
+ */
+static void unpack (Robot *robot, unsigned char *packed)
+{
+    int c; /* generic counter */
+
+    /* unpack the static attributes */
+    robot->type = packed[0];
+    robot->ramsize = packed[1];
+    robot->haswalker = (packed[2] & 1) != 0;
+    robot->hasspring = (packed[2] & 2) != 0;
+    robot->hasphaser = (packed[2] & 4) != 0;
+    robot->hasinventory = (packed[2] & 8) != 0;
+    robot->rom = packed[3];
+
+    /* unpack the changing attributes */
+    robot->facing = packed[4];
+    for (c = 0; c < 8; ++c)
+	robot->ram[c] = c < robot->ramsize ? packed[5 + c] : 0;
+
+    /* unpack the name */
+    memcpy (robot->name, packed + 13, 8);
+    robot->name[8] = '\0';
+}
+
 /**
  * Perform an action.
  * @param robot  The robot to act.
@@ -198,8 +302,10 @@ Robot *new_Robot (int type)
 {
     Robot *robot; /* new robot */
 
-    /* attempt to reserve memory */
-    if (! (robot = malloc (sizeof (Robot))))
+    /* reuse a destroyed robot or reserve memory for a new one */
+    if (pooled)
+	robot = pool[--pooled];
+    else if (! (robot = malloc (sizeof (Robot))))
 	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
 
     /* initialise attributes */
@@ -212,10 +318,38 @@ Robot *new_Robot (int type)
     robot->clear = clear;
     robot->write = write;
     robot->read = read;
+    robot->pack = pack;
+    robot->unpack = unpack;
     robot->act = act;
 
     /* return the new robot */
     return robot;
 }
 
+/**
+ * Construct a robot with the standard stats for its type. These are
+ * the stats written to the asset file for the game to use.
+ * @param  type The robot type 1..7.
+ * @return      The new robot.
+ */
+Robot *new_StandardRobot (int type)
+{
+    Robot *robot; /* new robot */
+    int *stats; /* pointer to the robot's stats */
+
+    /* create the robot */
+    robot = new_Robot (type);
+    stats = robotstats[type - 1];
+
+    /* fill in the name and stats */
+    strcpy (robot->name, robotnames[type - 1]);
+    robot->ramsize = stats[0];
+    robot->haswalker = stats[1];
+    robot->hasspring = stats[2];
+    robot->hasphaser = stats[3];
+    robot->hasinventory = stats[4];
+    robot->rom = stats[5];
 
+    /* return the new robot */
+    return robot;
+}
@@ -0,0 +1,881 @@
+/*======================================================================
+ * Team Droid: Jam Edition
+ * A programming puzzle game with cute robots.
+ *
+ * Copyright (C) Damian Gareth Walker, 2022.
+ * Level Solver Module.
+ */
+
+/*----------------------------------------------------------------------
+ * Required Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* project specific headers */
+#include "solver.h"
+#include "engine.h"
+#include "level.h"
+#include "cell.h"
+#include "item.h"
+#include "robot.h"
+#include "action.h"
+#include "fatal.h"
+
+
+/*----------------------------------------------------------------------
+ * Constants.
+ */
+
+/** @const TABLECHUNK The number of entries in a chunk of the table. */
+#define TABLECHUNK 4096
+
+/** @const MAXCHUNKS The number of table chunks allowed. */
+#define MAXCHUNKS (SOLVER_MAXSTATES / TABLECHUNK)
+
+/** @const BUCKETSIZE The number of table slots a state may occupy. */
+#define BUCKETSIZE 4
+
+/** @const DEAD The remaining turns recorded for a hopeless state. */
+#define DEAD 0xff
+
+/** @const MAXROBOTS The number of robots the solver can track. */
+#define MAXROBOTS 64
+
+/** @const MAXDATA The size of the largest encoded state. */
+#define MAXDATA (3 + 6 * 192 + MAXROBOTS)
+
+/** @const MAXDEPTH The number of moves in the longest line searched. */
+#define MAXDEPTH (8 * SOLVER_MAXTURNS)
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/**
+ * @struct entry
+ * A state remembered in the transposition table.
+ */
+typedef struct entry Entry;
+struct entry {
+
+    /** @var check The second hash of the state, to tell states apart. */
+    unsigned long check;
+
+    /**
+     * @var remaining
+     * The turns searched from the state without finding a solution,
+     * DEAD if every line from it fails, or 0 for an empty slot.
+     */
+    unsigned char remaining;
+
+};
+
+/**
+ * @struct frame
+ * A state on the line being searched, and the actions tried from it.
+ */
+typedef struct frame Frame;
+struct frame {
+
+    /** @var data The encoded level state. */
+    unsigned char *data;
+
+    /** @var length The length of the encoded level state. */
+    int length;
+
+    /** @var turn The turn in which the state is reached. */
+    int turn;
+
+    /** @var move The next move to be played from the state. */
+    int move;
+
+    /** @var hash The hash of the state, giving its table slot. */
+    unsigned long hash;
+
+    /** @var check The second hash of the state. */
+    unsigned long check;
+
+    /** @var playercount The number of surviving player robots. */
+    int playercount;
+
+    /** @var players The identifiers of the surviving player robots. */
+    unsigned char players[6];
+
+    /** @var alphabet The actions open to each player robot. */
+    unsigned char alphabet[6][1 + ACTION_SHOOT];
+
+    /** @var sizes The number of actions open to each player robot. */
+    unsigned char sizes[6];
+
+    /** @var combination The next combination of actions to try. */
+    long combination;
+
+    /** @var combinations The number of combinations of actions. */
+    long combinations;
+
+    /** @var actions The actions of the last combination, by type. */
+    unsigned char actions[6];
+
+    /** @var cutoff 1 if a line from here reached the turn limit. */
+    int cutoff;
+
+};
+
+/** @var table The transposition table, in chunks of TABLECHUNK. */
+static Entry *table[MAXCHUNKS];
+
+/** @var tablesize The number of entries in the table. */
+static long tablesize;
+
+/** @var frames The states on the line being searched. */
+static Frame frames[MAXDEPTH];
+
+/** @var scratch The level on which moves are played out. */
+static Level *scratch = NULL;
+
+/** @var initialcells The cell types in the initial level. */
+static int initialcells[192];
+
+/** @var templates The robots, indexed by identifier. */
+static Robot *templates[MAXROBOTS];
+
+/** @var live The robots on the scratch level, indexed by identifier. */
+static Robot *live[MAXROBOTS];
+
+/** @var order The robots on the scratch level in priority order. */
+static Robot *order[MAXROBOTS];
+
+/** @var ordercount The number of robots in the priority order. */
+static int ordercount;
+
+/** @var buffer A buffer for encoding a level state. */
+static unsigned char buffer[MAXDATA];
+
+/** @var started The time the current search started. */
+static time_t started;
+
+/*----------------------------------------------------------------------
+ * Level 3 Function Definitions.
+ */
+
+/**
+ * Return a pointer to a table entry.
+ * @param  slot The slot number, which may run past the end.
+ * @return      A pointer to the entry.
+ */
+static Entry *getentry (unsigned long slot)
+{
+    slot %= (unsigned long) tablesize;
+    return &table[slot / TABLECHUNK][slot % TABLECHUNK];
+}
+
+/**
+ * Look up a robot's identifier on the scratch level.
+ * @param  robot The robot to look up.
+ * @return       The robot's identifier.
+ */
+static int robotid (Robot *robot)
+{
+    int id; /* identifier counter */
+    for (id = 1; id < MAXROBOTS; ++id)
+	if (live[id] == robot)
+	    return id;
+    return 0;
+}
+
+/**
+ * Check whether a robot could ever carry out an action. An action that
+ * needs equipment the robot lacks, which is not lying on the level
+ * either, always fails and so leaves things as waiting would.
+ * @param  robot  The robot.
+ * @param  action The action.
+ * @param  lying  Nonzero for each type of item lying on the level.
+ * @return        1 if the action is worth trying, 0 if not.
+ */
+static int usable (Robot *robot, int action, int *lying)
+{
+    switch (action) {
+    case ACTION_STEPLEFT:
+    case ACTION_STEPRIGHT:
+	return robot->haswalker || lying[ITEM_WALKER];
+    case ACTION_LEAP:
+	return robot->hasspring || lying[ITEM_SPRING];
+    case ACTION_SHOOT:
+	return robot->hasphaser || lying[ITEM_PHASER];
+    case ACTION_TAKE:
+    case ACTION_DROP:
+	return robot->hasinventory;
+    default:
+	return 1;
+    }
+}
+
+/**
+ * Decode a stored state onto the scratch level.
+ * @param frame The frame holding the state.
+ */
+static void decodestate (Frame *frame)
+{
+    unsigned char *data; /* pointer into the encoded data */
+    int c, /* cell counter */
+	count, /* count of things to decode */
+	id; /* robot identifier */
+    Item *item; /* pointer to a new item */
+    Robot *robot; /* pointer to a new robot */
+
+    /* clear the scratch level */
+    data = frame->data;
+    scratch->clear (scratch);
+    for (c = 0; c < 192; ++c)
+	scratch->setcell (scratch, c, get_Cell (initialcells[c]));
+    for (id = 0; id < MAXROBOTS; ++id)
+	live[id] = NULL;
+
+    /* decode the changed cells */
+    for (count = *data++; count; --count, data += 2)
+	scratch->setcell (scratch, data[0], get_Cell (data[1]));
+
+    /* decode the items */
+    for (count = *data++; count; --count, data += 2) {
+	item = new_Item (data[1] & 0x0f);
+	item->status = data[1] >> 4;
+	scratch->setitem (scratch, data[0], item);
+    }
+
+    /* decode the robots */
+    for (count = *data++; count; --count, data += 2) {
+	id = data[1] & 0x3f;
+	robot = templates[id]->clone (templates[id]);
+	robot->x = data[0] % 16;
+	robot->y = data[0] / 16;
+	robot->facing = data[1] >> 6;
+	robot->status = ROBOT_INERT;
+	scratch->setrobot (scratch, data[0], live[id] = robot);
+    }
+
+    /* decode the priority order */
+    for (ordercount = 0; data < frame->data + frame->length; ++data)
+	order[ordercount++] = live[*data];
+}
+
+/*----------------------------------------------------------------------
+ * Level 2 Function Definitions.
+ */
+
+/**
+ * Encode the scratch level into the buffer. Only the cells that have
+ * changed since the start of the level are recorded.
+ * @return The length of the encoded state.
+ */
+static int encodestate (void)
+{
+    int c, /* cell counter */
+	r, /* robot counter */
+	count, /* offset of the current count byte */
+	length = 0; /* length of the encoded state */
+    Item *item; /* pointer to an item */
+    Robot *robot; /* pointer to a robot */
+
+    /* encode the changed cells */
+    count = length++;
+    buffer[count] = 0;
+    for (c = 0; c < 192; ++c)
+	if (scratch->cells[c]->type != initialcells[c]) {
+	    buffer[length++] = c;
+	    buffer[length++] = scratch->cells[c]->type;
+	    ++buffer[count];
+	}
+
+    /* encode the items and their statuses */
+    count = length++;
+    buffer[count] = 0;
+    for (c = 0; c < 192; ++c)
+	if ((item = scratch->items[c])) {
+	    buffer[length++] = c;
+	    buffer[length++] = item->type | (item->status << 4);
+	    ++buffer[count];
+	}
+
+    /* encode the robots and their facings */
+    count = length++;
+    buffer[count] = 0;
+    for (c = 0; c < 192; ++c)
+	if ((robot = scratch->robots[c])) {
+	    buffer[length++] = c;
+	    buffer[length++] = robotid (robot) | (robot->facing << 6);
+	    ++buffer[count];
+	}
+
+    /* encode the priority order of the surviving robots */
+    for (r = 0; r < ordercount; ++r)
+	if (order[r])
+	    buffer[length++] = robotid (order[r]);
+
+    /* return the length */
+    return length;
+}
+
+/**
+ * Hash the state in the buffer along with the move it was reached at,
+ * as the robots' RAM sizes limit the actions open to them.
+ * @param frame The frame to receive the state's hashes.
+ */
+static void hashstate (Frame *frame)
+{
+    unsigned long hash = 2166136261UL, /* the hash value */
+	check = 0; /* the second hash value */
+    unsigned char *data; /* pointer into the encoded state */
+    int length; /* bytes remaining */
+
+    /* hash the move */
+    hash = (hash ^ frame->move) * 16777619UL;
+    check = frame->move;
+
+    /* hash the encoded state */
+    for (data = buffer, length = frame->length; length--; ++data) {
+	hash = (hash ^ *data) * 16777619UL;
+	check = (check + *data + 1) * 2654435761UL;
+    }
+
+    /* store the results */
+    frame->hash = hash;
+    frame->check = check;
+}
+
+/**
+ * Check whether a state has already been searched deeply enough.
+ * @param  frame     The frame holding the state.
+ * @param  remaining The turns left to search from the state.
+ * @return           -1 if it needs searching, 0 if it has no line
+ *                   worth pursuing, 1 if it was cut off at the limit.
+ */
+static int knownstate (Frame *frame, int remaining)
+{
+    int probe; /* probe counter */
+    Entry *entry; /* pointer to a table entry */
+
+    /* look for the state in its bucket */
+    for (probe = 0; probe < BUCKETSIZE; ++probe) {
+	entry = getentry (frame->hash + probe);
+	if (entry->remaining && entry->check == frame->check) {
+	    if (entry->remaining == DEAD)
+		return 0;
+	    return entry->remaining >= remaining ? 1 : -1;
+	}
+    }
+
+    /* the state has not been seen */
+    return -1;
+}
+
+/**
+ * Remember that a state has been searched without finding a solution.
+ * When its bucket is full, the entry with least search behind it is
+ * forgotten to make room.
+ * @param solver    The solver, for its statistics.
+ * @param frame     The frame holding the state.
+ * @param remaining The turns searched from the state, or DEAD.
+ */
+static void rememberstate (Solver *solver, Frame *frame, int remaining)
+{
+    int probe; /* probe counter */
+    Entry *entry, /* pointer to a table entry */
+	*victim = NULL; /* the entry to replace */
+
+    /* update the state's entry, or choose one to replace */
+    for (probe = 0; probe < BUCKETSIZE; ++probe) {
+	entry = getentry (frame->hash + probe);
+	if (entry->remaining && entry->check == frame->check) {
+	    if (remaining > entry->remaining)
+		entry->remaining = remaining;
+	    return;
+	}
+	if (! victim || entry->remaining < victim->remaining)
+	    victim = entry;
+    }
+
+    /* store the state in place of the chosen entry */
+    if (victim->remaining)
+	++solver->forgotten;
+    victim->check = frame->check;
+    victim->remaining = remaining;
+}
+
+/**
+ * Push the state in the buffer onto the line being searched, and work
+ * out the actions open to each player robot.
+ * @param solver The solver.
+ * @param frame  The frame to fill, with its length, turn and move set.
+ */
+static void pushstate (Solver *solver, Frame *frame)
+{
+    int a, /* action counter */
+	p, /* action alphabet counter */
+	action, /* the action to consider */
+	id, /* robot identifier */
+	c, /* cell counter */
+	lying[ITEM_LAST]; /* nonzero for item types lying on the level */
+    unsigned char *alphabet, /* the alphabet being built */
+	*size; /* its size */
+    Robot *robot; /* pointer to a player robot */
+
+    /* keep a copy of the state and put it on the scratch level */
+    if (! (frame->data = malloc (frame->length)))
+	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+    memcpy (frame->data, buffer, frame->length);
+    decodestate (frame);
+    ++solver->states;
+
+    /* note the equipment lying on the level */
+    memset (lying, 0, sizeof (lying));
+    for (c = 0; c < 192; ++c)
+	if (scratch->items[c])
+	    lying[scratch->items[c]->type] = 1;
+
+    /* work out the actions open to each player robot, allowing the
+       whole library as any order of it might be dealt */
+    frame->playercount = 0;
+    frame->combinations = 1;
+    for (id = 1; id <= 6; ++id) {
+	if (! (robot = live[id]))
+	    continue;
+	frame->players[frame->playercount] = id;
+	alphabet = frame->alphabet[frame->playercount];
+	size = &frame->sizes[frame->playercount];
+	*size = 0;
+	for (a = -1; a <= ACTION_SHOOT && frame->move < robot->ramsize;
+	     ++a) {
+	    if (a == -1)
+		action = robot->rom;
+	    else
+		action = a;
+	    if (! usable (robot, action, lying))
+		continue;
+	    for (p = 0; p < *size; ++p)
+		if (alphabet[p] == action)
+		    break;
+	    if (p == *size)
+		alphabet[(*size)++] = action;
+	}
+	if (! *size)
+	    alphabet[(*size)++] = ACTION_NONE;
+	frame->combinations *= *size;
+	++frame->playercount;
+    }
+
+    /* nothing has been tried yet */
+    frame->combination = 0;
+    frame->cutoff = 0;
+}
+
+/**
+ * Play the next combination of actions from a state on the line.
+ * @param frame The frame holding the state.
+ */
+static void playcombination (Frame *frame)
+{
+    int p, /* player robot counter */
+	action; /* the action to play */
+    long rest; /* remaining digits of the combination */
+
+    /* the scratch level holds the state only before the first one */
+    if (frame->combination)
+	decodestate (frame);
+
+    /* program the robots and play the move */
+    memset (frame->actions, 0, 6);
+    for (rest = frame->combination, p = 0; p < frame->playercount; ++p) {
+	action = frame->alphabet[p][rest % frame->sizes[p]];
+	rest /= frame->sizes[p];
+	live[frame->players[p]]->ram[frame->move] = action;
+	frame->actions[frame->players[p] - 1] = action;
+    }
+    simulate_move (scratch, order, ordercount, frame->move, NULL);
+    ++frame->combination;
+}
+
+/**
+ * Fill in the solution from the line being searched.
+ * @param solver The solver.
+ * @param depth  The depth of the move that completed the level.
+ * @param types  The robot type deployed on each spawner.
+ */
+static void tracesolution (Solver *solver, int depth, unsigned char *types)
+{
+    int d, /* depth counter */
+	p; /* robot counter */
+
+    /* copy the deployment and the program of each move */
+    memset (solver->programs, 0, sizeof (solver->programs));
+    for (p = 0; p < SOLVER_MAXSPAWNERS; ++p)
+	solver->deployment[p] = types[p];
+    for (d = 0; d <= depth; ++d)
+	for (p = 0; p < 6; ++p)
+	    solver->programs[frames[d].turn][p][frames[d].move]
+		= frames[d].actions[p];
+    solver->turns = frames[depth].turn + 1;
+}
+
+/*----------------------------------------------------------------------
+ * Level 1 Function Definitions.
+ */
+
+/**
+ * Prepare the solver's internal data for a new level.
+ * @param  solver The solver.
+ * @param  level  The level to solve.
+ * @return        The search result if the level cannot be searched,
+ *                or -1 if it can.
+ */
+static int initialisesearch (Solver *solver, Level *level)
+{
+    int c, /* cell counter */
+	id = 7; /* next guard identifier */
+
+    /* prepare the scratch level and the transposition table */
+    if (! scratch)
+	scratch = new_Level ();
+    tablesize = (solver->maxstates + TABLECHUNK - 1)
+	/ TABLECHUNK * TABLECHUNK;
+    if (tablesize > SOLVER_MAXSTATES)
+	tablesize = SOLVER_MAXSTATES;
+    else if (tablesize < TABLECHUNK)
+	tablesize = TABLECHUNK;
+    for (c = 0; c < tablesize / TABLECHUNK; ++c)
+	if (! (table[c] = calloc (TABLECHUNK, sizeof (Entry))))
+	    fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+
+    /* make templates for the player robots */
+    for (c = 1; c <= 6; ++c)
+	templates[c] = new_StandardRobot (c);
+    for (c = 7; c < MAXROBOTS; ++c)
+	templates[c] = NULL;
+
+    /* note the cells, spawners and guards */
+    solver->spawnercount = 0;
+    for (c = 0; c < 192; ++c) {
+	initialcells[c] = level->cells[c]->type;
+	if (level->items[c] && level->items[c]->type == ITEM_SPAWNER) {
+	    if (solver->spawnercount == SOLVER_MAXSPAWNERS)
+		return SOLVER_TOOBIG;
+	    solver->spawners[solver->spawnercount++] = c;
+	}
+	if (level->robots[c]) {
+	    if (id == MAXROBOTS)
+		return SOLVER_TOOBIG;
+	    templates[id++] = level->robots[c]->clone (level->robots[c]);
+	}
+    }
+
+    /* without spawners, no robots can be deployed */
+    return solver->spawnercount ? -1 : SOLVER_UNSOLVABLE;
+}
+
+/**
+ * Deploy a combination of robots on the scratch level.
+ * @param  solver      The solver.
+ * @param  level       The level in its initial state.
+ * @param  combination The combination number.
+ * @param  types       The robot type on each spawner, or 0.
+ * @return             1 if the combination is valid, 0 if not.
+ */
+static int deploy (Solver *solver, Level *level, long combination,
+		   unsigned char *types)
+{
+    int s, /* spawner counter */
+	t, /* type counter */
+	c, /* cell counter */
+	x, /* x coordinate of spawner */
+	y, /* y coordinate of spawner */
+	id; /* next guard identifier */
+    Robot *robot; /* pointer to a deployed robot */
+
+    /* work out the robot on each spawner */
+    memset (types, 0, 6);
+    for (s = 0; s < solver->spawnercount; ++s) {
+	types[s] = combination % 7;
+	combination /= 7;
+	for (t = 0; t < s; ++t)
+	    if (types[s] && types[t] == types[s])
+		return 0;
+    }
+
+    /* build the level without its spawners */
+    scratch->clear (scratch);
+    for (id = 0; id < MAXROBOTS; ++id)
+	live[id] = NULL;
+    id = 7;
+    for (c = 0; c < 192; ++c) {
+	scratch->setcell (scratch, c, level->cells[c]);
+	if (level->items[c] && level->items[c]->type != ITEM_SPAWNER)
+	    scratch->setitem (scratch, c,
+			      level->items[c]->clone (level->items[c]));
+	if (level->robots[c]) {
+	    live[id] = templates[id]->clone (templates[id]);
+	    scratch->setrobot (scratch, c, live[id++]);
+	}
+    }
+
+    /* deploy the robots, facing as on the deployment screen */
+    for (s = 0; s < solver->spawnercount; ++s) {
+	if (! types[s])
+	    continue;
+	x = solver->spawners[s] % 16;
+	y = solver->spawners[s] / 16;
+	robot = templates[types[s]]->clone (templates[types[s]]);
+	if (x < 2 + y && x < 13 - y)
+	    robot->facing = ROBOT_EAST;
+	else if (x > 2 + y && x > 13 - y)
+	    robot->facing = ROBOT_WEST;
+	else if (y < 6)
+	    robot->facing = ROBOT_SOUTH;
+	else
+	    robot->facing = ROBOT_NORTH;
+	robot->x = x;
+	robot->y = y;
+	live[types[s]] = robot;
+	scratch->setrobot (scratch, solver->spawners[s], robot);
+    }
+
+    /* the deployment is ready */
+    ordercount = simulate_priorities (scratch, order);
+    return 1;
+}
+
+/**
+ * Search depth-first for a solution from the deployment on the
+ * scratch level, within a limit on the number of turns.
+ * @param  solver The solver.
+ * @param  limit  The number of turns to search.
+ * @param  types  The robot type deployed on each spawner.
+ * @param  cutoff Set to 1 if any line reached the turn limit.
+ * @return        1 if solved, 0 if not, -1 if out of time.
+ */
+static int searchdeployment (Solver *solver, int limit,
+			     unsigned char *types, int *cutoff)
+{
+    int depth = 0, /* depth of the current state */
+	turn, /* turn of the next state */
+	move, /* move of the next state */
+	known, /* what is known of the next state */
+	result = 0; /* the result of the search */
+    Frame *frame, /* the current state */
+	*next; /* the next state */
+
+    /* start with the deployment, unless it has been searched */
+    frame = &frames[0];
+    frame->turn = frame->move = 0;
+    frame->length = encodestate ();
+    hashstate (frame);
+    if ((known = knownstate (frame, limit)) != -1) {
+	*cutoff |= known;
+	return 0;
+    }
+    pushstate (solver, frame);
+
+    /* search until every line from the deployment is played out */
+    while (depth >= 0) {
+	frame = &frames[depth];
+
+	/* remember a state once every line from it is played out */
+	if (frame->combination == frame->combinations) {
+	    rememberstate (solver, frame,
+			   frame->cutoff ? limit - frame->turn : DEAD);
+	    if (depth)
+		frames[depth - 1].cutoff |= frame->cutoff;
+	    else
+		*cutoff |= frame->cutoff;
+	    free (frame->data);
+	    --depth;
+	    continue;
+	}
+
+	/* play the next move, finishing the turn after the last */
+	playcombination (frame);
+	turn = frame->turn;
+	move = frame->move + 1;
+	if (move == 8) {
+	    simulate_endturn (scratch);
+	    if (simulate_complete (scratch)) {
+		tracesolution (solver, depth, types);
+		result = 1;
+		break;
+	    }
+	    if (simulate_failed (scratch))
+		continue;
+	    if (++turn == limit) {
+		frame->cutoff = 1;
+		continue;
+	    }
+	    move = 0;
+	    ordercount = simulate_priorities (scratch, order);
+	}
+
+	/* skip the new state if it has been searched deeply enough */
+	next = &frames[depth + 1];
+	next->turn = turn;
+	next->move = move;
+	next->length = encodestate ();
+	hashstate (next);
+	if ((known = knownstate (next, limit - turn)) != -1) {
+	    frame->cutoff |= known;
+	    continue;
+	}
+
+	/* check the time budget before searching on */
+	if (time (NULL) - started > solver->timelimit) {
+	    result = -1;
+	    break;
+	}
+	pushstate (solver, next);
+	++depth;
+    }
+
+    /* free the line if the search was cut short */
+    for (; depth >= 0; --depth)
+	free (frames[depth].data);
+    return result;
+}
+
+/**
+ * Free the memory used by the search.
+ */
+static void finishsearch (void)
+{
+    int c; /* chunk counter */
+    int id; /* robot identifier */
+
+    /* free the transposition table */
+    for (c = 0; c < MAXCHUNKS && table[c]; ++c) {
+	free (table[c]);
+	table[c] = NULL;
+    }
+
+    /* free the robot templates and the scratch level */
+    for (id = 0; id < MAXROBOTS; ++id)
+	if (templates[id]) {
+	    templates[id]->destroy (templates[id]);
+	    templates[id] = NULL;
+	}
+    scratch->clear (scratch);
+}
+
+/*----------------------------------------------------------------------
+ * Public Method Function Definitions.
+ */
+
+/**
+ * Destroy the solver when it is no longer needed.
+ * @param solver The solver to destroy.
+ */
+static void destroy (Solver *solver)
+{
+    if (solver) {
+	if (scratch) {
+	    scratch->destroy (scratch);
+	    scratch = NULL;
+	}
+	free (solver);
+    }
+}
+
+/**
+ * Search for the shortest solution to a level. Each pass searches
+ * every deployment depth-first to one more turn than the last, so
+ * only the line being searched is kept, along with a table of states
+ * already searched; a full table forgets states rather than giving up.
+ * @param  solver The solver.
+ * @param  level  The level in its initial state.
+ * @return        The search result.
+ */
+static int solve (Solver *solver, Level *level)
+{
+    int limit, /* turn limit for the current pass */
+	cutoff, /* 1 if a line reached the turn limit */
+	s, /* spawner counter */
+	result; /* result of searching a deployment */
+    long combination, /* deployment combination number */
+	combinations = 1; /* total number of combinations */
+    unsigned char types[6]; /* robot type on each spawner */
+
+    /* initialise the search */
+    started = time (NULL);
+    solver->result = SOLVER_GAVEUP;
+    solver->turns = 0;
+    solver->states = 0;
+    solver->forgotten = 0;
+    if ((result = initialisesearch (solver, level)) != -1)
+	solver->result = result;
+    for (s = 0; s < solver->spawnercount; ++s)
+	combinations *= 7;
+
+    /* search one turn deeper on each pass */
+    for (limit = 1; solver->result == SOLVER_GAVEUP &&
+	     limit <= solver->maxturns; ++limit) {
+
+	/* search each deployment in turn */
+	cutoff = 0;
+	result = 0;
+	for (combination = 1; combination < combinations; ++combination)
+	    if (deploy (solver, level, combination, types) &&
+		(result = searchdeployment
+		 (solver, limit, types, &cutoff)) != 0)
+		break;
+
+	/* stop if solved or out of time */
+	if (result == 1)
+	    solver->result = SOLVER_SOLVED;
+	if (result)
+	    break;
+
+	/* if no line reached the limit, the level cannot be solved */
+	solver->turns = limit;
+	if (! cutoff)
+	    solver->result = SOLVER_UNSOLVABLE;
+    }
+
+    /* clean up and return the result */
+    finishsearch ();
+    return solver->result;
+}
+
+/*----------------------------------------------------------------------
+ * Top Level Function Definitions.
+ */
+
+/**
+ * Construct a new solver.
+ * @return The new solver.
+ */
+Solver *new_Solver (void)
+{
+    Solver *solver; /* the new solver */
+
+    /* reserve memory for the solver */
+    if (! (solver = malloc (sizeof (Solver))))
+	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+
+    /* initialise methods */
+    solver->destroy = destroy;
+    solver->solve = solve;
+
+    /* initialise settings */
+    solver->timelimit = 60;
+    solver->maxturns = SOLVER_MAXTURNS;
+    solver->maxstates = SOLVER_DEFAULTSTATES;
+
+    /* initialise results */
+    solver->result = SOLVER_GAVEUP;
+    solver->turns = 0;
+    solver->states = 0;
+    solver->forgotten = 0;
+    solver->spawnercount = 0;
+
+    /* return the new solver */
+    return solver;
+}
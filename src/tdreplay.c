@@ -0,0 +1,207 @@
+/*======================================================================
+ * Team Droid: Jam Edition
+ * A programming puzzle game with cute robots.
+ *
+ * Copyright (C) Damian Gareth Walker, 2022.
+ * Journal Replay Program.
+ */
+
+/*----------------------------------------------------------------------
+ * Headers
+ */
+
+/* ANSI C headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* project-specific headers */
+#include "journal.h"
+#include "levelpak.h"
+#include "level.h"
+#include "item.h"
+#include "robot.h"
+#include "engine.h"
+#include "fatal.h"
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/** @var journal is the journal being replayed. */
+static Journal *journal;
+
+/** @var levelpack is the level pack the journal was played on. */
+static LevelPack *levelpack;
+
+/** @var level is the level being replayed, or NULL if unknown. */
+static Level *level = NULL;
+
+/** @var mismatches is the number of turns that did not match. */
+static int mismatches = 0;
+
+/** @var journalturn is the turn being replayed, too big for the stack. */
+static JournalTurn journalturn;
+
+/*----------------------------------------------------------------------
+ * Level 1 Functions.
+ */
+
+/**
+ * Set up the level as it was after the robots were deployed.
+ * @param turn The first turn played after deployment.
+ */
+static void deployrobots (JournalTurn *turn)
+{
+    int c; /* general counter */
+    Item *spawner; /* a spawner to remove */
+    Robot *robot; /* a robot to deploy */
+
+    /* start from the level as it is in the level pack */
+    if (! level)
+	level = new_Level ();
+    level->copy (level, levelpack->levels[turn->levelid]);
+
+    /* remove the spawners */
+    for (c = 0; c < 192; ++c)
+	if ((spawner = level->items[c]) && spawner->type == ITEM_SPAWNER) {
+	    level->setitem (level, c, NULL);
+	    spawner->destroy (spawner);
+	}
+
+    /* place the player's robots; the guards are already there */
+    for (c = 0; c < turn->robotcount; ++c)
+	if (turn->types[c] != ROBOT_GUARD) {
+	    robot = new_StandardRobot (turn->types[c]);
+	    robot->x = turn->locations[c] % 16;
+	    robot->y = turn->locations[c] / 16;
+	    robot->facing = turn->facings[c];
+	    level->setrobot (level, turn->locations[c], robot);
+	}
+}
+
+/**
+ * Put the robots into their recorded order and load their programs.
+ * @param  turn   The turn being replayed.
+ * @param  robots The array to hold the robots in priority order.
+ * @return        1 if the robots match the journal, 0 if not.
+ */
+static int loadrobots (JournalTurn *turn, Robot **robots)
+{
+    int c, /* robot counter */
+	s; /* RAM slot counter */
+    Robot *robot; /* pointer to a robot */
+
+    for (c = 0; c < turn->robotcount; ++c) {
+	robot = level->robots[turn->locations[c]];
+	if (! robot ||
+	    robot->type != turn->types[c] ||
+	    robot->facing != turn->facings[c])
+	    return 0;
+	for (s = 0; s < 8; ++s)
+	    robot->ram[s] = turn->ram[c][s];
+	robots[c] = robot;
+    }
+    return 1;
+}
+
+/*----------------------------------------------------------------------
+ * Level 2 Functions.
+ */
+
+/**
+ * Initialise the command line options.
+ * @param argc is the argument count.
+ * @param argv is the array of arguments.
+ */
+static void initialiseoptions (int argc, char **argv)
+{
+    if (argc != 2 || *argv[1] == '-' || strlen (argv[1]) > 12)
+	fatalerror (FATAL_COMMAND_LINE, __FILE__, __LINE__);
+    journal = new_Journal ();
+    strcpy (journal->filename, argv[1]);
+}
+
+/**
+ * Open the journal and load the level pack it was played on.
+ */
+static void openjournal (void)
+{
+    if (! journal->open (journal))
+	fatalerror (FATAL_NODATA, __FILE__, __LINE__);
+    if (! (levelpack = new_LevelPack ()))
+	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+    strcpy (levelpack->filename, journal->levelpackfile);
+    if (! levelpack->load (levelpack, 0))
+	fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
+}
+
+/**
+ * Replay a single turn from the journal and report its hash.
+ * @param turn The turn to replay.
+ */
+static void replayturn (JournalTurn *turn)
+{
+    Robot *robots[JOURNAL_MAXROBOTS]; /* robots in priority order */
+    unsigned long hash; /* hash of the replayed outcome */
+
+    /* report the turn */
+    printf ("Level %d turn %d: ", turn->levelid + 1, turn->turnno + 1);
+
+    /* the first turn of a level attempt sets up the level afresh */
+    if (turn->deployed &&
+	turn->levelid < 12 &&
+	levelpack->levels[turn->levelid])
+	deployrobots (turn);
+
+    /* make sure the robots are where the journal expects */
+    if (! level || ! loadrobots (turn, robots)) {
+	printf ("out of step with the journal.\n");
+	if (level)
+	    level->destroy (level);
+	level = NULL;
+	++mismatches;
+	return;
+    }
+
+    /* play the turn and compare the outcome */
+    simulate_turn (level, robots, turn->robotcount, NULL);
+    hash = simulate_hash (level);
+    printf ("%08lx %s", hash, hash == turn->hash ? "ok" : "MISMATCH");
+    if (hash != turn->hash)
+	++mismatches;
+    if (simulate_complete (level))
+	printf (", level complete");
+    else if (simulate_failed (level))
+	printf (", level failed");
+    printf (".\n");
+}
+
+/*----------------------------------------------------------------------
+ * Top Level Function.
+ */
+
+/**
+ * Main Program.
+ * @param argc is the command line argument count.
+ * @param argv is the array of command line arguments.
+ * @return 0 if every turn matched, 1 if not.
+ */
+int main (int argc, char **argv)
+{
+    /* initialisation */
+    initialiseoptions (argc, argv);
+    openjournal ();
+
+    /* replay the turns */
+    while (journal->read (journal, &journalturn))
+	replayturn (&journalturn);
+    printf ("%d mismatch(es).\n", mismatches);
+
+    /* clean up */
+    if (level)
+	level->destroy (level);
+    levelpack->destroy (levelpack);
+    journal->destroy (journal);
+    return mismatches ? 1 : 0;
+}
@@ -25,6 +25,7 @@
 #include "game.h"
 #include "robot.h"
 #include "uiscreen.h"
+#include "profile.h"
 
 /*----------------------------------------------------------------------
  * Data Definitions
@@ -41,6 +42,9 @@ static int colourset = 2;
 /** @var quiet Game is silent if 1, or has sound and music if 0. */
 static int quiet = 0;
 
+/** @var record Action playback is recorded as GIFs if 1. */
+static int record = 0;
+
 /** @var controls The controls object. */
 static Controls *controls = NULL;
 
@@ -84,6 +88,8 @@ static void initialiseargs (int argc, char **argv)
 	    colourset = 0;
 	else if (! strcmp (argv[c], "-q"))
 	    quiet = 1;
+	else if (! strcmp (argv[c], "-g"))
+	    record = 1;
 	else
 	    fatalerror (FATAL_COMMAND_LINE, __FILE__, __LINE__);
 }
@@ -101,6 +107,7 @@ static void initialiseprogram (int argc, char **argv)
 {
     /* check command line */
     initialiseargs (argc, argv);
+    PROFILE_OPEN ("profile.log");
 
     /* initialise the random number generator */
     srand (time (NULL));
@@ -110,7 +117,7 @@ static void initialiseprogram (int argc, char **argv)
 	fatalerror (FATAL_DISPLAY, __FILE__, __LINE__);
 
     /* initialise the display and assets */
-    if (! (display = new_Display (colourset, quiet)))
+    if (! (display = new_Display (colourset, quiet, record)))
 	fatalerror (FATAL_DISPLAY, __FILE__, __LINE__);
     display->showtitlescreen ();
 
@@ -196,6 +203,7 @@ static void endprogram (void)
     config->destroy ();
     destroy_Cells ();
     destroy_Actions ();
+    PROFILE_CLOSE ();
 }
 
 /**
@@ -226,25 +234,25 @@ Config *getconfig (void)
 }
 
 /**
- * Load the robots from the already-open asset file.
- * @param input The asset file handle.
+ * Load the robots from the asset data.
+ * @param packed The packed player robots followed by the guard robot.
  */
-void loadrobotdetails (FILE *input)
+void loadrobotdetails (unsigned char *packed)
 {
     int c; /* robot counter */
 
-    /* read the player robots */
-    for (c = 0; c < 6; ++c)
+    /* unpack the player robots */
+    for (c = 0; c < 6; ++c, packed += ROBOT_PACKEDSIZE)
 	if (! (playerrobots[c] = new_Robot (c + 1)))
 	    fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
-	else if (! playerrobots[c]->read (playerrobots[c], input))
-	    fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
+	else
+	    playerrobots[c]->unpack (playerrobots[c], packed);
 
-    /* read the guard robot */
+    /* unpack the guard robot */
     if (! (guardrobot = new_Robot (7)))
 	fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
-    else if (! guardrobot->read (guardrobot, input))
-	fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
+    else
+	guardrobot->unpack (guardrobot, packed);
 }
 
 /**
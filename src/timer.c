@@ -16,7 +16,7 @@
 
 /* project headers */
 #include "timer.h"
-#include "fatal.h"
+#include "profile.h"
 
 
 /*----------------------------------------------------------------------
@@ -24,28 +24,30 @@
  */
 
 /**
- * Destroy the timer without waiting for it to end.
- * @param timer The timer to destroy.
+ * Find out how long is left before the timer ends.
+ * @param  timer The timer.
+ * @return       The milliseconds remaining, or 0 if it has ended.
  */
-static void destroy (Timer *timer)
+static int remaining (Timer *timer)
 {
-    free (timer);
+    struct timeb now; /* the current time */
+    int left; /* time remaining */
+    ftime (&now);
+    left = (timer->end.time - now.time) * 1000 +
+	timer->end.millitm - now.millitm;
+    return left > 0 ? left : 0;
 }
 
 /**
- * Wait for the timer to complete, then destroy it.
- * @param timer The timer to destroy.
+ * Wait for the timer to complete.
+ * @param timer The timer to wait for.
  */
 static void wait (Timer *timer)
 {
-    struct timeb now; /* the current time */
-    int remaining; /* time remaining */
-    do {
-	ftime (&now);
-	remaining = (timer->end.time - now.time) * 1000 +
-	    timer->end.millitm - now.millitm;
-    } while (remaining > 0);
-    free (timer);
+    PROFILE_START (PROFILE_DELAY);
+    while (remaining (timer))
+	;
+    PROFILE_STOP (PROFILE_DELAY);
 }
 
 /*----------------------------------------------------------------------
@@ -53,21 +55,15 @@ static void wait (Timer *timer)
  */
 
 /**
- * Create a new timer and set it going.
- * @param  milliseconds The length of the timer.
- * @return              The new timer.
+ * Set a timer going.
+ * @param timer        The timer to start.
+ * @param milliseconds The length of the timer.
  */
-Timer *new_Timer (int milliseconds)
+void start_Timer (Timer *timer, int milliseconds)
 {
-    Timer *timer; /* the new timer */
-
-    /* reserve memory for timer */
-    if (! (timer = malloc (sizeof (Timer))))
-	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
-
     /* initialise methods */
-    timer->destroy = destroy;
     timer->wait = wait;
+    timer->remaining = remaining;
 
     /* initialise attributes */
     ftime (&timer->end);
@@ -76,8 +72,4 @@ Timer *new_Timer (int milliseconds)
 	++timer->end.time;
 	timer->end.millitm -= 1000;
     }
-
-    /* return the new timer */
-    return timer;
 }
-
@@ -11,6 +11,7 @@
  */
 
 /* standard C headers */
+#include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -27,9 +28,10 @@
 #include "game.h"
 #include "level.h"
 #include "robot.h"
-#include "item.h"
-#include "action.h"
+#include "engine.h"
+#include "journal.h"
 #include "timer.h"
+#include "profile.h"
 #include "fatal.h"
 
 
@@ -37,6 +39,35 @@
  * Data Definitions.
  */
 
+/**
+ * @struct phaserbeam
+ * The location of a phaser beam.
+ */
+typedef struct phaserbeam PhaserBeam;
+struct phaserbeam {
+
+    /** @var hit 1 when the phaser has hit something */
+    int hit;
+
+    /** @var blast 1 if the phaser ends its path with a blast. */
+    int blast;
+
+    /** @var range Number of squares left on the phaser's path. */
+    int range;
+
+    /** @var x Current x coordinate. */
+    int x;
+
+    /** @var y Current y coordinate. */
+    int y;
+
+    /** @var xf X facing offset. */
+    int xf;
+
+    /** @var yf Y facing offset. */
+    int yf;
+};
+
 /**
  * @struct uiscreendata
  * Data for the deployment screen.
@@ -49,12 +80,21 @@ struct uiscreendata {
     /** @var level The state of the level in the current frame. */
     Level *level;
 
+    /** @var snapshot The state of the level at the start of the turn. */
+    LevelSnapshot *snapshot;
+
     /** @var robots The robots on the level, in priority order. */
-    Robot **robots;
+    Robot *robots[192];
 
     /** @var robotcount The number of robots/guards on the level. */
     int robotcount;
 
+    /** @var journalturn The turn as it will be written to the journal. */
+    JournalTurn journalturn;
+
+    /** @var events The events of the phase being played back. */
+    EventList *events;
+
     /** @var move The current move of the action. */
     int move;
 
@@ -70,29 +110,12 @@ struct uiscreendata {
     /** @var beeped 1 if a beep has been played this move. */
     int beeped;
 
-};
+    /** @var playback The playback speed of the current playback. */
+    int playback;
 
-/**
- * @struct phaserbeam
- * The location of a phaser beam.
- */
-typedef struct phaserbeam PhaserBeam;
-struct phaserbeam {
-
-    /** @var hit 1 when the phaser has hit something */
-    int hit;
+    /** @var phaserbeams The phaser beams of the shooting phase. */
+    PhaserBeam phaserbeams[DISPLAY_MAXBEAMS];
 
-    /** @var x Current x coordinate. */
-    int x;
-
-    /** @var y Current y coordinate. */
-    int y;
-
-    /** @var xf X facing offset. */
-    int xf;
-
-    /** @var yf Y facing offset. */
-    int yf;
 };
 
 /** @var display A pointer to the display module. */
@@ -109,10 +132,19 @@ static char *actionmenu[] = {
     "Cancel menu",
     "Replay",
     "Done",
+    "Change speed",
     "New game",
     "Exit game"
 };
 
+/** @var playbacknames Descriptions of the playback speeds. */
+static char *playbacknames[] = {
+    "Playback at normal speed.",
+    "Playback at fast speed.",
+    "Playback skips to the end.",
+    "Hold fire to fast forward."
+};
+
 /** @var xoffset The x offset for each facing. */
 static int xoffset[] = {
     0, /* north */
@@ -134,224 +166,49 @@ static int yoffset[] = {
  */
 
 /**
- * Do the shooting animations.
- * @param uiscreen The user interface screen.
- */
-static void doshootinganimations (UIScreen *uiscreen, int move,
-				  int phasercount)
-{
-    PhaserBeam *phaserbeams; /* the phaser beams */
-    Robot **robots; /* pointer to list of robots */
-    Level *level; /* pointer to level state */
-    int r, /* robot count */
-	p, /* phaser beam count */
-	x, /* x location of robot */
-	y, /* y location of robot */
-	xf, /* x facing of robot */
-	yf, /* y facing of robot */
-	pos, /* position of beam in transit */
-	allhit, /* all phaser beams have hit their target */
-	blast; /* there is a blast to display */
-    Timer *timer; /* a delay timer to control the animation */
-
-    /* allocate memory for phaser beams */
-    if (! (phaserbeams = malloc (phasercount * sizeof (PhaserBeam))))
-	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
-
-    /* set convenience variables */
-    robots = uiscreen->data->robots;
-    level = uiscreen->data->level;
-
-    /* initialise phaser beams */
-    for (r = 0, p = 0; r < uiscreen->data->robotcount; ++r) {
-
-	/* ingore dead robots and those not shooting */
-	if (! robots[r])
-	    continue;
-	if (robots[r]->ram[move] != ACTION_SHOOT)
-	    continue;
-
-	/* work out robot coordinates */
-	x = robots[r]->x;
-	y = robots[r]->y;
-	if ((! level->items[x + 16 * y] ||
-	     level->items[x + 16 * y]->type != ITEM_PHASER) &&
-	    ! robots[r]->hasphaser)
-	    continue;
-	xf = xoffset[robots[r]->facing];
-	yf = yoffset[robots[r]->facing];
-
-	/* ignore robots firing off the map */
-	if (x + xf < 0 || x + xf > 15 || y + yf < 0 || y + yf > 11)
-	    continue;
-
-	/* start the phaser */
-	phaserbeams[p].hit = 0;
-	phaserbeams[p].x = x + xf;
-	phaserbeams[p].y = y + yf;
-	phaserbeams[p].xf = xf;
-	phaserbeams[p].yf = yf;
-	display->showphaserbeam (phaserbeams[p].x, phaserbeams[p].y,
-				 abs (phaserbeams[p].xf));
-	++p;
-
-    }
-    timer = new_Timer (125);
-    /* put sound here */
-    timer->wait (timer);
-
-    /* start moving phaser beams */
-    do {
-
-	/* initialise */
-	blast = 0;
-	allhit = 1;
-	timer = new_Timer (125);
-
-	/* look at all the phaser bolts */
-	for (p = 0; p < phasercount; ++p) {
-
-	    /* ignore beams that have hit something */
-	    if (phaserbeams[p].hit)
-		continue;
-
-	    /* remove the phaser beam */
-	    pos = phaserbeams[p].x + 16 * phaserbeams[p].y;
-	    display->hidephaserbeam (level, pos);
-
-	    /* has the phaser beam hit something? */
-	    if (level->cells[pos]->allowshoot ||
-		level->items[pos] ||
-		level->robots[pos]) {
-		blast = phaserbeams[p].hit = 1;
-		display->showblast (phaserbeams[p].x, phaserbeams[p].y);
-		continue;
-	    } else if (phaserbeams[p].x + phaserbeams[p].xf < 0 ||
-		phaserbeams[p].x + phaserbeams[p].xf > 15 ||
-		phaserbeams[p].y + phaserbeams[p].yf < 0 ||
-		phaserbeams[p].y + phaserbeams[p].yf > 11) {
-		phaserbeams[p].hit = 1;
-		continue;
-	    }
-
-	    /* advance the phaser beam */
-	    phaserbeams[p].x += phaserbeams[p].xf;
-	    phaserbeams[p].y += phaserbeams[p].yf;
-	    display->showphaserbeam (phaserbeams[p].x,
-				     phaserbeams[p].y,
-				     abs (phaserbeams[p].xf));
-	    allhit = 0;
-
-	}
-
-	/* update the display */
-	timer->wait (timer);
-
-    } while (! allhit);
-
-    /* erase all phaser beams */
-    free (phaserbeams);
-    display->showlevelmap (level);
-    display->update ();
-}
-
-/**
- * Remove robots that are destroyed, and reset statuses of others.
+ * Scale an animation delay to the playback speed.
  * @param  uiscreen The user interface screen.
- * @return          1 if any robots were destroyed.
+ * @param  msecs    The delay at normal speed.
+ * @return          The delay at the current speed.
  */
-static void resetrobotstatuses (UIScreen *uiscreen)
+static int playbackdelay (UIScreen *uiscreen, int msecs)
 {
-    int r; /* robot counter */
-    Level *level; /* the current level state */
-    Robot **robots; /* pointer to the prioritised robots */
-
-    /* set convenience variables */
-    level = uiscreen->data->level;
-    robots = uiscreen->data->robots;
-
-    /* scan the level for robots */
-    for (r = 0; r < uiscreen->data->robotcount; ++r)
-	if (robots[r])
-	    robots[r]->status = ROBOT_INERT;
+    if (uiscreen->data->playback == PLAYBACK_FAST)
+	return msecs / 4;
+    if (uiscreen->data->playback == PLAYBACK_HOLD && controls->fire ())
+	return msecs / 4;
+    return msecs;
 }
 
 /**
- * Remove robots that are destroyed, and reset statuses of others.
- * @param  uiscreen The user interface screen.
- * @return          1 if any robots were destroyed.
+ * Hide the phaser beams in flight, last drawn first, so that each
+ * restores the screen exactly as it was before the beam was drawn.
+ * @param beams The phaser beams.
+ * @param shots The number of phaser beams.
  */
-static int checkdestroyedrobots (UIScreen *uiscreen)
+static void hidephaserbeams (PhaserBeam *beams, int shots)
 {
-    int r, /* robot counter */
-	destroyed = 0; /* robots destroyed */
-    Level *level; /* the current level state */
-    Robot **robots; /* pointer to the prioritised robots */
-
-    /* set convenience variables */
-    level = uiscreen->data->level;
-    robots = uiscreen->data->robots;
-
-    /* scan the level for robots */
-    for (r = 0; r < uiscreen->data->robotcount; ++r)
-	if (! robots[r])
-	    ; /* no robot here */
-	else if (robots[r]->status == ROBOT_DESTROYED) {
-	    display->showblast (robots[r]->x, robots[r]->y);
-	    level->robots[robots[r]->x + 16 * robots[r]->y] = NULL;
-	    robots[r]->destroy (robots[r]);
-	    robots[r] = NULL;
-	    destroyed = 1;
-	}
-
-    /* return 1 if robots were destroyed */
-    return destroyed;
-}
-
-/**
- * Remove items that are destroyed, without resetting other statuses.
- * @param  level The level to scan for items.
- * @return       1 if any items were destroyed
- */
-static int checkdestroyeditems (Level *level)
-{
-    int c, /* cell counter */
-	destroyed = 0; /* 1 if items were destroyed */
-
-    /* scan the map for items */
-    for (c = 0; c < 192; ++c)
-	if (! level->items[c])
-	    ; /* no item here */
-	else if (level->robots[c])
-	    ; /* item is being carried */
-	else if (level->items[c]->status == ITEM_DESTROYED) {
-	    level->items[c]->destroy (level->items[c]);
-	    level->items[c] = NULL;
-	    display->showlevelmapsquare (level, c);
-	    display->showblast (c % 16, c / 16);
-	}
-
-    /* return 1 if items were destroyed */
-    return destroyed;
+    int p; /* phaser beam count */
+    for (p = shots - 1; p >= 0; --p)
+	if (! beams[p].hit)
+	    display->hidephaserbeam (p);
 }
 
 /**
- * Remove items that are dsetroyed, and reset statuses of others.
- * @param level The level to scan for items.
+ * Show the phaser beams in flight.
+ * @param beams  The phaser beams.
+ * @param shots  The number of phaser beams.
+ * @param offset Pixels moved from each beam's square into the next.
  */
-static void resetitemstatuses (Level *level)
+static void showphaserbeams (PhaserBeam *beams, int shots, int offset)
 {
-    int c; /* cell counter */
-    for (c = 0; c < 192; ++c)
-	if (! level->items[c])
-	    ; /* no item here */
-	else if (level->robots[c])
-	    ; /* item is being carried */
-	else if (level->items[c]->status == ITEM_DESTROYED) {
-	    level->items[c]->destroy (level->items[c]);
-	    level->items[c] = NULL;
-	} else
-	    level->items[c]->status = ITEM_INERT;
+    int p; /* phaser beam count */
+    for (p = 0; p < shots; ++p)
+	if (! beams[p].hit)
+	    display->showphaserbeam (p,
+				     16 * beams[p].x + offset * beams[p].xf,
+				     16 * beams[p].y + offset * beams[p].yf,
+				     abs (beams[p].xf));
 }
 
 /*----------------------------------------------------------------------
@@ -359,264 +216,180 @@ static void resetitemstatuses (Level *level)
  */
 
 /**
- * Play the first part of any sprint actions assigned to the robots.
+ * Do the shooting animations.
  * @param uiscreen The user interface screen.
- * @param move     The move number.
+ * @param shots    The number of phaser beams fired.
  */
-static int playsprintactions (UIScreen *uiscreen, int move)
+static void doshootinganimations (UIScreen *uiscreen, int shots)
 {
-    Robot **robots; /* pointer to prioritised robot list */
-    Level *level; /* pointer to level state */
-    Action *action; /* the action to perform */
-    int r, /* robot counter */
-	sprinting = 0, /* 1 if any robots are sprinting */
-	destroyed = 0; /* 1 if anything was destroyed */
-    Timer *timer; /* timer for blast noise */
+    PhaserBeam *beams; /* the phaser beams */
+    EventList *events; /* the events of the shooting phase */
+    Event *event; /* pointer to an event */
+    int e, /* event count */
+	p, /* phaser beam count */
+	range = 0, /* squares crossed by the longest beam */
+	step, /* squares crossed so far */
+	duration, /* time taken for a beam to cross a square */
+	offset, /* pixels moved into the next square */
+	moved; /* pixels moved by the current time */
+    long elapsed; /* time since the beams set off */
+    Timer timer; /* a delay timer to control the animation */
 
     /* set convenience variables */
-    robots = uiscreen->data->robots;
-    level = uiscreen->data->level;
-
-    /* execute any sprint actions */
-    for (r = 0; r < uiscreen->data->robotcount; ++r)
-	if (robots[r] &&
-	    robots[r]->status != ROBOT_DESTROYED &&
-	    robots[r]->ram[move] == ACTION_SPRINT) {
-	    action = get_Action (ACTION_SPRINT);
-	    action->execute (action, robots[r], level);
-	    sprinting = 1;
-	}
-
-    /* check if anything was destroyed and let the player see the blasts */
-    if (checkdestroyedrobots (uiscreen))
-	destroyed = 1;
-    if (checkdestroyeditems (uiscreen->data->level))
-	destroyed = 1;
-    if (destroyed) {
-	timer = new_Timer (250);
-	display->playsound (DISPLAY_NOISE_BLAST);
-	uiscreen->data->beeped = 1;
-	timer->wait (timer);
-    }
+    events = uiscreen->data->events;
+    beams = uiscreen->data->phaserbeams;
+    if (shots > DISPLAY_MAXBEAMS)
+	shots = DISPLAY_MAXBEAMS;
 
-    /* update the display if any sprint actions occurred */
-    if (sprinting) {
-	display->showlevelmap (level);
-	display->update ();
-	if (! uiscreen->data->beeped) {
-	    display->playsound (DISPLAY_NOISE_MOVE);
-	    uiscreen->data->beeped = 1;
-	}
-	delay (250);
+    /* initialise phaser beams */
+    for (e = 0, p = 0; e < events->count && p < shots; ++e) {
+	event = &events->events[e];
+	if (event->type != EVENT_SHOT)
+	    continue;
+	beams[p].hit = 0;
+	beams[p].x = event->x;
+	beams[p].y = event->y;
+	beams[p].xf = xoffset[event->value];
+	beams[p].yf = yoffset[event->value];
+	beams[p].range = event->range;
+	beams[p].blast = event->hit;
+	if (beams[p].range > range)
+	    range = beams[p].range;
+	++p;
     }
-
-    /* tell calling process if there was any action */
-    return sprinting;
-}
-
-/**
- * Play any action except shoot.
- * @param uiscreen The user interface screen.
- * @param move     The move number.
- */
-static int playgeneralactions (UIScreen *uiscreen, int move)
-{
-    Robot **robots; /* pointer to prioritised robot list */
-    Level *level; /* pointer to level state */
-    Action *action; /* the action to perform */
-    int r, /* robot counter */
-	actionsdone = 0, /* 1 if any actions were performed */
-	destroyed = 0; /* 1 if anything was destroyed */
-    Timer *timer; /* timer for blast noise */
-
-    /* set convenience variables */
-    robots = uiscreen->data->robots;
-    level = uiscreen->data->level;
-
-    /* execute any non-shooting actions */
-    for (r = 0; r < uiscreen->data->robotcount; ++r)
-	if (robots[r] &&
-	    robots[r]->status != ROBOT_DESTROYED &&
-	    move < robots[r]->ramsize) {
-	    if (robots[r]->ram[move] != ACTION_SHOOT &&
-		robots[r]->ram[move] != ACTION_NONE) {
-		actionsdone = 1;
-		action = get_Action (robots[r]->ram[move]);
-		action->execute (action, robots[r], level);
+    showphaserbeams (beams, shots, 0);
+    start_Timer (&timer, playbackdelay (uiscreen, 125));
+    timer.wait (&timer);
+
+    /* one timer paces the whole flight */
+    duration = playbackdelay (uiscreen, 125);
+    start_Timer (&timer, duration * range);
+    for (step = 0; step < range; ++step) {
+
+	/* stop the phaser beams that have reached the end of their path */
+	hidephaserbeams (beams, shots);
+	for (p = 0; p < shots; ++p)
+	    if (! beams[p].hit && --beams[p].range == 0) {
+		beams[p].hit = 1;
+		if (beams[p].blast)
+		    display->showblast (beams[p].x, beams[p].y);
 	    }
-	}
 
-    /* check if anything was destroyed and let the player see the blasts */
-    if (checkdestroyedrobots (uiscreen))
-	destroyed = 1;
-    if (checkdestroyeditems (uiscreen->data->level))
-	destroyed = 1;
-    if (destroyed) {
-	timer = new_Timer (250);
-	display->playsound (DISPLAY_NOISE_BLAST);
-	uiscreen->data->beeped = 1;
-	timer->wait (timer);
-    }
+	/* slide the rest into the next square as fast as time allows */
+	offset = -1;
+	do {
+	    elapsed = (long) duration * range - timer.remaining (&timer);
+	    moved = (int) (16 * elapsed / duration) - 16 * step;
+	    if (moved > 16)
+		moved = 16;
+	    if (moved == offset)
+		continue;
+	    if (offset != -1)
+		hidephaserbeams (beams, shots);
+	    offset = moved;
+	    showphaserbeams (beams, shots, offset);
+	    display->update ();
+	} while (offset < 16);
 
-    /* update the display */
-    if (actionsdone) {
-	display->showlevelmap (level);
-	display->update ();
-	if (! uiscreen->data->beeped) {
-	    display->playsound (DISPLAY_NOISE_MOVE);
-	    uiscreen->data->beeped = 1;
-	}
-	delay (250);
+	/* the phaser beams are now in the next square */
+	for (p = 0; p < shots; ++p)
+	    if (! beams[p].hit) {
+		beams[p].x += beams[p].xf;
+		beams[p].y += beams[p].yf;
+	    }
     }
-
-    /* tell calling process if there was any action */
-    return actionsdone;
 }
 
+/*----------------------------------------------------------------------
+ * Level 2 Function Definitions.
+ */
+
 /**
- * Play shoot actions.
- * @param uiscreen The user interface screen.
- * @param move     The move number.
+ * Resolve one phase of a move and play back what happened.
+ * @param  uiscreen The user interface screen.
+ * @param  move     The move number.
+ * @param  phase    The phase of the move.
+ * @return          1 if there was any action.
  */
-static int playshootactions (UIScreen *uiscreen, int move)
+static int playphase (UIScreen *uiscreen, int move, int phase)
 {
-    Robot **robots; /* pointer to prioritised robot list */
+    EventList *events; /* the events of this phase */
+    Event *event; /* pointer to an event */
     Level *level; /* pointer to level state */
-    Action *action; /* the action to perform */
-    int r, /* robot counter */
-	shooting = 0, /* 1 if any robots are shooting */
-	destroyed = 0; /* 1 if anything was destroyed */
-    Timer *timer; /* timer for blast noise */
+    int e, /* event counter */
+	activity, /* nonzero if any actions or effects happened */
+	shots = 0, /* number of phaser beams fired */
+	destroyed = 0, /* 1 if anything was destroyed */
+	teleport = 0; /* 1 if a teleport was activated */
+    Timer timer; /* timer for blast noise */
 
     /* set convenience variables */
-    robots = uiscreen->data->robots;
+    events = uiscreen->data->events;
     level = uiscreen->data->level;
 
-    /* execute any shooting actions */
-    for (r = 0; r < uiscreen->data->robotcount; ++r)
-	if (robots[r] &&
-	    robots[r]->ram[move] == ACTION_SHOOT) {
-	    action = get_Action (ACTION_SHOOT);
-	    action->execute (action, robots[r], level);
-	    ++shooting;
-	}
+    /* resolve the phase */
+    PROFILE_START (phase);
+    PROFILE_START (PROFILE_RULES);
+    events->clear (events);
+    activity = simulate_phase (level, uiscreen->data->robots,
+			       uiscreen->data->robotcount, move, phase,
+			       events);
+    PROFILE_STOP (PROFILE_RULES);
+    for (e = 0; e < events->count; ++e)
+	if (events->events[e].type == EVENT_SHOT)
+	    ++shots;
+	else if (events->events[e].type == EVENT_TELEPORT)
+	    teleport = 1;
 
     /* do the shooting animation */
-    if (shooting) {
+    if (phase == ENGINE_SHOOT && activity) {
 	display->playsound (DISPLAY_NOISE_PEWPEW);
 	uiscreen->data->beeped = 1;
-	doshootinganimations (uiscreen, move, shooting);
+	doshootinganimations (uiscreen, shots);
     }
 
-    /* check if anything was destroyed and let the player see the blasts */
-    if (checkdestroyedrobots (uiscreen))
-	destroyed = 1;
-    if (checkdestroyeditems (uiscreen->data->level))
-	destroyed = 1;
-    if (destroyed) {
-	timer = new_Timer (250);
-	display->playsound (DISPLAY_NOISE_BLAST);
-	uiscreen->data->beeped = 1;
-	timer->wait (timer);
-    }
-
-    /* reset the robot statuses */
-    checkdestroyedrobots (uiscreen);
-    resetrobotstatuses (uiscreen);
-
-    /* update the display if any shooting actions occurred */
-    if (shooting) {
-	display->showlevelmap (level);
-	display->update ();
-	if (! uiscreen->data->beeped) {
-	    display->playsound (DISPLAY_NOISE_MOVE);
-	    uiscreen->data->beeped = 1;
-	}
-	delay (250);
-    }
-
-    /* tell calling process if there was any action */
-    return shooting;
-}
-
-/**
- * Play any cell effects.
- * @param uiscreen The user interface screen.
- * @param move     The move number.
- * @param sprint   Effects for sprinting robots only.
- */
-static int playeffects (UIScreen *uiscreen, int move, int sprint)
-{
-    int effects = 0, /* 1 if any effects happened */
-	effect, /* 1 if the current cell had an effect */
-	c, /* general counter */
-	destroyed = 0, /* 1 if something was destroyed */
-	teleport = 0; /* 1 if a teleport was activated */
-    Level *level; /* a pointer to the level */
-    Cell *cell; /* pointer to current cell */
-    Robot *robot; /* pointer to a robot on a cell */
-    Item *item; /* pointer to an item on a cell */
-    Timer *timer; /* timer for any blast noise */
-
-    /* initialise convenience variables */
-    level = uiscreen->data->level;
-
-    /* sweep through all of the cells */
-    for (c = 0; c < 192; ++c) {
-	cell = level->cells[c];
-	robot = level->robots[c];
-	if (sprint && robot && robot->ram[move] != ACTION_SPRINT)
-	    continue;
-	if (robot && move < robot->ramsize) {
-	    effect = cell->onrobot (level, c % 16, c / 16);
-	    if (effect && cell->type == CELL_TELEPORTER)
-		teleport = 1;
-	    effects |= effect;
-	} else if ((item = level->items[c])) {
-	    effect = cell->onitem (level, c % 16, c / 16);
-	    if (effect && cell->type == CELL_TELEPORTER)
-		teleport = 1;
-	    effects |= effect;
+    /* let the player see the blasts of anything destroyed */
+    for (e = 0; e < events->count; ++e) {
+	event = &events->events[e];
+	if (event->type == EVENT_DESTROYROBOT) {
+	    display->showblast (event->x, event->y);
+	    destroyed = 1;
+	} else if (event->type == EVENT_DESTROYITEM) {
+	    display->showlevelmapsquare (level, event->x + 16 * event->y);
+	    display->showblast (event->x, event->y);
+	    destroyed = 1;
 	}
     }
-
-    /* reset the robot statuses */
-    if (checkdestroyedrobots (uiscreen))
-	destroyed = 1;
-    if (checkdestroyeditems (uiscreen->data->level))
-	destroyed = 1;
     if (destroyed) {
- 	timer = new_Timer (250);
+	start_Timer (&timer, playbackdelay (uiscreen, 250));
 	display->playsound (DISPLAY_NOISE_BLAST);
 	uiscreen->data->beeped = 1;
-	timer->wait (timer);
+	timer.wait (&timer);
     } else if (teleport) {
- 	timer = new_Timer (250);
+	start_Timer (&timer, playbackdelay (uiscreen, 250));
 	display->playsound (DISPLAY_NOISE_TELEPORT);
 	uiscreen->data->beeped = 1;
-	timer->wait (timer);
+	timer.wait (&timer);
     }
-    resetrobotstatuses (uiscreen);
 
-    /* update the level and display */
-    if (effects) {
-	display->showlevelmap (level);
+    /* update the display if anything happened */
+    if (activity) {
+	display->showlevelmapchanges (level);
 	display->update ();
 	if (! uiscreen->data->beeped) {
 	    display->playsound (DISPLAY_NOISE_MOVE);
 	    uiscreen->data->beeped = 1;
 	}
-	delay (250);
+	PROFILE_START (PROFILE_DELAY);
+	delay (playbackdelay (uiscreen, 250));
+	PROFILE_STOP (PROFILE_DELAY);
     }
 
-    /* return whether effects happened */
-    return effects;
+    /* tell calling process if there was any action */
+    PROFILE_STOP (phase);
+    return activity != 0;
 }
 
-/*----------------------------------------------------------------------
- * Level 2 Function Definitions.
- */
-
 /**
  * Play a single move of a turn.
  * @param uiscreen The user interface screen.
@@ -624,24 +397,27 @@ static int playeffects (UIScreen *uiscreen, int move, int sprint)
  */
 static void playmove (UIScreen *uiscreen, int move)
 {
-    Timer *timer; /* timer to ensure user sees actions */
+    Timer timer; /* timer to ensure user sees actions */
     int actions = 0, /* 1 if there were any actions */
 	effects = 0; /* 1 if there were any effects */
 
     /* start the timer */
     uiscreen->data->beeped = 0;
-    timer = new_Timer (1000);
+    start_Timer (&timer, playbackdelay (uiscreen, 1000));
 
     /* action and effects from the sprinting phase */
-    actions |= playsprintactions (uiscreen, move);
-    effects |= playeffects (uiscreen, move, 1);
+    actions |= playphase (uiscreen, move, ENGINE_SPRINT);
+    effects |= playphase (uiscreen, move, ENGINE_SPRINTEFFECTS);
 
     /* actions and effects from the rest of the move */
-    actions |= playgeneralactions (uiscreen, move);
-    actions |= playshootactions (uiscreen, move);
-    if (actions)
-	delay (250);
-    effects |= playeffects (uiscreen, move, 0);
+    actions |= playphase (uiscreen, move, ENGINE_GENERAL);
+    actions |= playphase (uiscreen, move, ENGINE_SHOOT);
+    if (actions) {
+	PROFILE_START (PROFILE_DELAY);
+	delay (playbackdelay (uiscreen, 250));
+	PROFILE_STOP (PROFILE_DELAY);
+    }
+    effects |= playphase (uiscreen, move, ENGINE_EFFECTS);
 
     /* update the progress bar */
     display->showprogressbar (1 + move);
@@ -649,9 +425,7 @@ static void playmove (UIScreen *uiscreen, int move)
 
     /* give the player time to see what happened */
     if (actions || effects)
-	timer->wait (timer);
-    else
-	timer->destroy (timer);
+	timer.wait (&timer);
 }
 
 /*----------------------------------------------------------------------
@@ -664,67 +438,71 @@ static void playmove (UIScreen *uiscreen, int move)
  */
 static void initreplaylevel (UIScreen *uiscreen)
 {
-    Level *level, /* level in progress */
-	*initial; /* pointer to initial level state */
-    int c, /* cell counter */
-	r, /* robot counter */
-	s, /* swap robot number */
-	seed = 0, /* random number seed */
-	robotcount = 0; /* the number of robots */
-    Robot **robots, /* pointer to prioritised robot list */
-	*swaprobot; /* pointer to a robot to swap */
-
-    /* clone the game level */
-    initial = uiscreen->data->game->level;
-    if (! (uiscreen->data->level = initial->clone (initial)))
-	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+    Level *level; /* level in progress */
+
+    /* restore the level from the start of the turn */
+    if (! uiscreen->data->level)
+	uiscreen->data->level = new_Level ();
     level = uiscreen->data->level;
+    level->restore (level, uiscreen->data->snapshot);
 
     /* initialise move counter */
     uiscreen->data->move = 0;
     uiscreen->data->playing = 1;
 
-    /* build the robot list and set a seed for their priorities */
-    for (c = 0; c < 192; ++c) {
-	seed ^= level->cells[c]->type;
-	if (level->robots[c])
-	    ++robotcount;
-    }
-    robots = uiscreen->data->robots;
-    if (! robots && ! (robots = malloc (robotcount * sizeof (Robot *))))
-	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
-    for (c = 0, r = 0; c < 192; ++c)
-	if (level->robots[c])
-	    robots[r++] = level->robots[c];
-
-    /* scramble the robot priorities according to the seed */
-    srand (seed);
-    for (r = 0; r < robotcount; ++r) {
-	s = rand () % robotcount;
-	swaprobot = robots[r];
-	robots[r] = robots[s];
-	robots[s] = swaprobot;
-    }
-
-    /* put robot list in ui screen data */
-    uiscreen->data->robots = robots;
-    uiscreen->data->robotcount = robotcount;
+    /* put the prioritised robot list in ui screen data */
+    uiscreen->data->robotcount = simulate_priorities
+	(level, uiscreen->data->robots);
 }
 
 /**
  * Play through the robots' actions.
  * @param uiscreen The user interface screen.
+ * @param playback The playback speed to use.
  */
-static void playactions (UIScreen *uiscreen)
+static void playactions (UIScreen *uiscreen, int playback)
 {
     int move; /* move counter */
+    Level *level; /* pointer to level state */
+    unsigned long allocations; /* heap allocations before playback */
+    unsigned int heapblocks; /* heap blocks in use before playback */
+
+    /* skip straight to the end of the turn if required */
+    uiscreen->data->playback = playback;
+    if (playback == PLAYBACK_SKIP) {
+	level = uiscreen->data->level;
+	PROFILE_START (PROFILE_RULES);
+	simulate_turn (level, uiscreen->data->robots,
+		       uiscreen->data->robotcount, NULL);
+	PROFILE_STOP (PROFILE_RULES);
+	display->showprogressbar (8);
+	display->showlevelmapchanges (level);
+	display->update ();
+	PROFILE_REPORT (uiscreen->data->game->levelid,
+			uiscreen->data->game->turnno);
+	return;
+    }
 
-    /* play through the moves */
+    /* play through the moves, recording them if required */
+    display->startcapture (uiscreen->data->game->levelid,
+			   uiscreen->data->game->turnno);
+    allocations = PROFILE_ALLOCATIONS ();
+    heapblocks = PROFILE_HEAPBLOCKS ();
     for (move = 0; move < 8; ++move)
 	playmove (uiscreen, move);
+    assert (PROFILE_ALLOCATIONS () == allocations);
+    /* robots and items shot when their pools are full are freed */
+    assert (PROFILE_HEAPBLOCKS () <= heapblocks);
+    display->stopcapture ();
 
     /* reset the item statuses */
-    resetitemstatuses (uiscreen->data->level);
+    simulate_endturn (uiscreen->data->level);
+    PROFILE_REPORT (uiscreen->data->game->levelid,
+		    uiscreen->data->game->turnno);
+
+    /* fire held to fast forward must not open the menu */
+    if (playback == PLAYBACK_HOLD)
+	while (controls->fire ());
 }
 
 /**
@@ -737,8 +515,62 @@ static void updatelevel (UIScreen *uiscreen)
     Level *level; /* pointer to the level */
     game = uiscreen->data->game;
     level = uiscreen->data->level;
-    game->level->destroy (game->level);
-    game->level = level->clone (level);
+    game->level->copy (game->level, level);
+}
+
+/**
+ * Note the library and the robots' programs at the start of the turn,
+ * before any robots are destroyed.
+ * @param uiscreen The user interface screen.
+ */
+static void startjournalturn (UIScreen *uiscreen)
+{
+    Game *game; /* pointer to the game */
+    JournalTurn *turn; /* the turn to record */
+    Robot *robot; /* pointer to a robot */
+    int c, /* general counter */
+	s; /* RAM slot counter */
+
+    /* note the turn and the library order */
+    game = uiscreen->data->game;
+    turn = &uiscreen->data->journalturn;
+    turn->levelid = game->levelid;
+    turn->turnno = game->turnno;
+    turn->deployed = game->deployed;
+    for (c = 0; c < 12; ++c)
+	turn->library[c] = game->library[c]->type;
+
+    /* note the robots in priority order */
+    turn->robotcount = uiscreen->data->robotcount;
+    for (c = 0; c < turn->robotcount; ++c) {
+	robot = uiscreen->data->robots[c];
+	turn->types[c] = robot->type;
+	turn->locations[c] = robot->x + 16 * robot->y;
+	turn->facings[c] = robot->facing;
+	for (s = 0; s < 8; ++s)
+	    turn->ram[c][s] = robot->ram[s];
+    }
+}
+
+/**
+ * Add the turn to the game's journal once the level is updated.
+ * @param uiscreen The user interface screen.
+ */
+static void writejournalturn (UIScreen *uiscreen)
+{
+    Game *game; /* pointer to the game */
+    Journal *journal; /* the game's journal */
+    JournalTurn *turn; /* the turn to record */
+
+    /* add the outcome and write the turn */
+    turn = &uiscreen->data->journalturn;
+    game = uiscreen->data->game;
+    turn->hash = simulate_hash (game->level);
+    journal = new_Journal ();
+    journal->setgame (journal, game->filename);
+    strcpy (journal->levelpackfile, game->levelpackfile);
+    journal->append (journal, turn);
+    journal->destroy (journal);
 }
 
 /*----------------------------------------------------------------------
@@ -756,8 +588,10 @@ static void destroy (UIScreen *uiscreen)
 	if (uiscreen->data) {
 	    if ((level = uiscreen->data->level))
 		level->destroy (level);
-	    if (uiscreen->data->robots)
-		free (uiscreen->data->robots);
+	    if (uiscreen->data->snapshot)
+		free (uiscreen->data->snapshot);
+	    if (uiscreen->data->events)
+		uiscreen->data->events->destroy (uiscreen->data->events);
 	    free (uiscreen->data);
 	}
 	free (uiscreen);
@@ -770,10 +604,14 @@ static void destroy (UIScreen *uiscreen)
  */
 static void init (UIScreen *uiscreen)
 {
+    Level *level; /* the game level */
     uiscreen->data->game->state = STATE_ACTION;
 
     /* grab the initial level state */
+    level = uiscreen->data->game->level;
+    uiscreen->data->snapshot = level->snapshot (level, NULL);
     initreplaylevel (uiscreen);
+    startjournalturn (uiscreen);
 }
 
 /**
@@ -794,14 +632,14 @@ static UIState show (UIScreen *uiscreen)
     display->update ();
 
     /* action playback */
-    playactions (uiscreen);
+    playactions (uiscreen, config->playback);
 
     /* main loop */
     while (1) {
 
 	/* get a choice from the menu */
 	while (! controls->fire ());
-	option = display->menu (5, actionmenu, 2);
+	option = display->menu (6, actionmenu, 2);
 	switch (option) {
 
 	case 0: /* cancel menu */
@@ -811,18 +649,19 @@ static UIState show (UIScreen *uiscreen)
 
 	case 1: /* replay action */
 	    display->showprogressbar (0);
-	    uiscreen->data->level->destroy (uiscreen->data->level);
 	    initreplaylevel (uiscreen);
-	    display->showlevelmap (uiscreen->data->level);
+	    display->showlevelmapchanges (uiscreen->data->level);
 	    display->update ();
 	    delay (250);
-	    playactions (uiscreen);
+	    playactions (uiscreen, config->playback == PLAYBACK_SKIP ?
+			 PLAYBACK_NORMAL : config->playback);
 	    break;
 
 	case 2: /* done with action */
 	    display->showprogressbar (8);
 	    display->update ();
 	    updatelevel (uiscreen);
+	    writejournalturn (uiscreen);
 	    game->turn (game);
 	    if (game->state == STATE_VICTORY)
 		uiscreen->informwithnoise
@@ -840,10 +679,15 @@ static UIState show (UIScreen *uiscreen)
 	    }
 	    return game->state;
 
-	case 3: /* new game */
+	case 3: /* playback speed */
+	    config->playback = (config->playback + 1) % PLAYBACK_LAST;
+	    uiscreen->inform (playbacknames[config->playback]);
+	    break;
+
+	case 4: /* new game */
 	    return STATE_NEWGAME;
 
-	case 4: /* exit game */
+	case 5: /* exit game */
 	    return STATE_QUIT;
 
 	}
@@ -883,12 +727,14 @@ UIScreen *new_ActionScreen (Game *game)
     /* initialise attributes */
     uiscreen->data->game = game;
     uiscreen->data->level = NULL;
-    uiscreen->data->robots = NULL;
+    uiscreen->data->snapshot = NULL;
     uiscreen->data->robotcount = 0;
+    uiscreen->data->events = new_EventList ();
     uiscreen->data->move = 0;
     uiscreen->data->won = 0;
     uiscreen->data->lost = 0;
     uiscreen->data->playing = 0;
+    uiscreen->data->playback = PLAYBACK_NORMAL;
 
     /* return the screen */
     return uiscreen;
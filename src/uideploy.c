@@ -183,6 +183,7 @@ static void deployrobot (UIScreen *uiscreen)
     Robot *current, /* current robot */
 	**robots; /* the robots array */
     Level *level; /* a pointer to the level */
+    Item *spawner; /* the spawner to replace */
     int cursor, /* the cursor location */
 	x, /* x cursor location */
 	y; /* y cursor location */
@@ -224,9 +225,10 @@ static void deployrobot (UIScreen *uiscreen)
 	current->y = y;
 	    
 	/* update the level and panel data */
-	level->robots[cursor] = current;
-	level->items[cursor]->destroy (level->items[cursor]);
-	level->items[cursor] = NULL;
+	spawner = level->items[cursor];
+	level->setitem (level, cursor, NULL);
+	spawner->destroy (spawner);
+	level->setrobot (level, cursor, current);
 	robots[current->type - 1] = NULL;
 
 	/* update the display */
@@ -272,8 +274,8 @@ static void removerobot (UIScreen *uiscreen)
 	    
 	/* put the robot back in the panel */
 	robots[robot->type - 1] = robot;
-	level->robots[cursor] = NULL;
-	level->items[cursor] = new_Item (ITEM_SPAWNER);
+	level->setrobot (level, cursor, NULL);
+	level->setitem (level, cursor, new_Item (ITEM_SPAWNER));
 
 	/* update the display */
 	display->showdeploymentrobot (robot->type, 1);
@@ -304,10 +306,11 @@ static int checkrobotdeployed (UIScreen *uiscreen)
 static void clearspawners (Level *level)
 {
     int c; /* cell counter */
+    Item *spawner; /* the spawner to remove */
     for (c = 0; c < 192; ++c)
-	if (level->items[c] && level->items[c]->type == ITEM_SPAWNER) {
-	    level->items[c]->destroy (level->items[c]);
-	    level->items[c] = NULL;
+	if ((spawner = level->items[c]) && spawner->type == ITEM_SPAWNER) {
+	    level->setitem (level, c, NULL);
+	    spawner->destroy (spawner);
 	}
 }
 
@@ -406,6 +409,7 @@ static UIState show (UIScreen *uiscreen)
 	case 4: /* proceed */
 	    if (checkrobotdeployed (uiscreen)) {
 		clearspawners (uiscreen->data->game->level);
+		uiscreen->data->game->deployed = 1;
 		uiscreen->data->game->state = STATE_PROGRAM;
 		uiscreen->data->game->shuffleactions (uiscreen->data->game);
 		return STATE_PROGRAM;
@@ -14,7 +14,6 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <direct.h>
 #include <time.h>
 #include <io.h>
 #include <ctype.h>
@@ -27,6 +26,9 @@
 #include "config.h"
 #include "game.h"
 #include "levelpak.h"
+#include "journal.h"
+#include "dirindex.h"
+#include "catalog.h"
 #include "fatal.h"
 
 
@@ -34,6 +36,29 @@
  * Data Definitions.
  */
 
+/**
+ * @struct game_ref A reference to the game on show.
+ */
+typedef struct game_ref GameRef;
+struct game_ref {
+
+    /** @var filename The game filename */
+    char filename[13];
+
+    /** @var name The game display name */
+    char name[33];
+
+    /** @var player The player's name */
+    char player[14];
+
+    /** @var packfile The filename of the level pack the game plays. */
+    char packfile[13];
+
+    /** @var packname The name of the level pack the game plays. */
+    char packname[14];
+
+};
+
 /**
  * @struct uiscreendata
  * Private data for this UI Screen.
@@ -43,48 +68,32 @@ struct uiscreendata {
     /** @var game The game to set up. */
     Game *game;
 
-    /** @var gameindex The index of the game file in the list. */
+    /** @var gameindex The game in the list, 0 for a new game. */
     int gameindex;
 
-    /** @var packindex The index of the level pack in the list. */
+    /** @var packindex The level pack in the list for a new game. */
     int packindex;
 
     /** @var highlight The highlighted setting. */
     int highlight;
 
-};
-
-/**
- * @struct pack_ref is a reference to an unloaded pack.
- */
-typedef struct pack_ref PackRef;
-struct pack_ref {
-
-    /** @var filename The pack filename. */
-    char filename[13];
-
-    /** @var name The pack display name. */
-    char name[33];
+    /** @var sort The order of the game list, a CatalogueSort. */
+    int sort;
 
-};
-
-/**
- * @struct game_ref A reference to an unloaded game.
- */
-typedef struct game_ref GameRef;
-struct game_ref {
+    /** @var player The player's name for a new game. */
+    char player[14];
 
-    /** @var filename The game filename */
-    char filename[13];
+    /** @var current The game on show. */
+    GameRef current;
 
-    /** @var name The game display name */
-    char name[33];
+    /** @var dirindex The index of the game directory. */
+    DirIndex *dirindex;
 
-    /** @var player The player's name */
-    char player[14];
+    /** @var games The list of in-progress games. */
+    Catalogue *games;
 
-    /** @var packindex Which level pack the game plays. */
-    int packindex;
+    /** @var packs The list of level packs. */
+    Catalogue *packs;
 
 };
 
@@ -97,99 +106,136 @@ static Controls *controls;
 /** @var config A pointer to the configuration. */
 static Config *config;
 
-/** @var gamerefs References to in-progress games found on disk. */
-static GameRef gamerefs[16];
-
-/** @var packrefs References to packs found on disk. */
-static PackRef packrefs[16];
-
 /** @var newgamemenu The menu for a new game. */
 static char *newgamemenu[] = {
     "Cancel menu",
     "Start game",
     "Delete game",
+    "Sort by score",
     "Exit game"
 };
 
 /*----------------------------------------------------------------------
- * Level 2 Private Function Definitions.
+ * Level 3 Private Function Definitions.
  */
 
 /**
- * Identify a levelpack file in the list by its filename.
- * @param  filename The filename of the levelpack.
- * @return          Its index in the list, or -1 if not found.
+ * Fill in the reference to the game on show from the lists.
+ * @param uiscreen A pointer to the screen.
  */
-static int identifylevelpack (char *filename)
+static void selectgame (UIScreen *uiscreen)
 {
-    int c = 0; /* levelpack index counter */
-    for (c = 0; c < 16; ++c)
-	if (! strcmp (packrefs[c].filename, filename))
-	    return c;
-    return -1;
+    GameRef *current; /* the game on show */
+    DirIndexEntry *entry; /* an entry from one of the lists */
+    char *ptr; /* pointer that strtol needs */
+    time_t t; /* time in seconds since epoch */
+    int packindex; /* the level pack in the list */
+
+    /* fill in the game details */
+    current = &uiscreen->data->current;
+    packindex = uiscreen->data->packindex;
+    if (uiscreen->data->gameindex == 0) {
+	*current->filename = '\0';
+	strcpy (current->name, "New game");
+	strcpy (current->player, uiscreen->data->player);
+    } else if ((entry = uiscreen->data->games->get
+		(uiscreen->data->games, uiscreen->data->gameindex - 1))) {
+	strcpy (current->filename, entry->filename);
+	t = strtol (entry->filename, &ptr, 16);
+	strftime (current->name, 32, "%Y-%m-%d %H:%M:%S",
+		  localtime(&t));
+	strcpy (current->player, entry->name);
+	packindex = uiscreen->data->games->packs
+	    [uiscreen->data->gameindex - 1];
+    }
+
+    /* fill in the level pack details */
+    if ((entry = uiscreen->data->packs->get
+	 (uiscreen->data->packs, packindex))) {
+	strcpy (current->packfile, entry->filename);
+	strcpy (current->packname, entry->name);
+    } else
+	*current->packfile = *current->packname = '\0';
 }
 
 /**
- * Adjust the game.
+ * Show a line of the game on show.
  * @param uiscreen  A pointer to the screen.
- * @param direction The direction to move along the list.
+ * @param line      The line to show.
+ * @param highlight 1 if line should be highlighted.
  */
-static void adjustgame (UIScreen *uiscreen, int direction)
+static void showoption (UIScreen *uiscreen, int line, int highlight)
 {
-    int c; /* field counter */
-    
-    /* adjust the game entry itself */
-    uiscreen->data->gameindex += direction;
-    if (uiscreen->data->gameindex >= 16 ||
-	uiscreen->data->gameindex < 0 ||
-	gamerefs[uiscreen->data->gameindex].name[0] == 0) {
-	uiscreen->data->gameindex -= direction;
-	return;
-    }
+    display->showgameoption
+	(uiscreen->data->current.name,
+	 uiscreen->data->current.player,
+	 uiscreen->data->current.packname,
+	 line,
+	 highlight);
+}
 
-    /* update the other fields internally */
-    uiscreen->data->packindex =
-	gamerefs[uiscreen->data->gameindex].packindex;
+/*----------------------------------------------------------------------
+ * Level 2 Private Function Definitions.
+ */
 
-    /* update the other fields on the screen */
-    for (c = 1; c < 3; ++c)
-	display->showgameoption
-	    (gamerefs[uiscreen->data->gameindex].name,
-	     gamerefs[uiscreen->data->gameindex].player,
-	     packrefs[uiscreen->data->packindex].name,
-	     c,
-	     -(uiscreen->data->gameindex != 0));
+/**
+ * Build the game and level pack lists from the directory index,
+ * then let the index free its entries until it is next refreshed.
+ * @param uiscreen A pointer to the screen.
+ */
+static void buildlists (UIScreen *uiscreen)
+{
+    DirIndex *dirindex; /* index of the game directory */
+    dirindex = uiscreen->data->dirindex;
+    if (! dirindex->refresh (dirindex))
+	fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
+    if (! uiscreen->data->packs->build
+	(uiscreen->data->packs, CATALOGUE_NAME, NULL))
+	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+    if (! uiscreen->data->games->build
+	(uiscreen->data->games, uiscreen->data->sort,
+	 uiscreen->data->packs))
+	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+    dirindex->release (dirindex);
 }
 
 /**
- * Rename the player.
+ * Move to another game, showing its details.
  * @param uiscreen  A pointer to the screen.
+ * @param gameindex The game to move to, 0 for a new game.
  */
-static void renameplayer (UIScreen *uiscreen)
+static void movetogame (UIScreen *uiscreen, int gameindex)
 {
-    display->renameplayer (gamerefs[uiscreen->data->gameindex].player);
+    int c; /* field counter */
+
+    /* adjust the game entry itself */
+    if (gameindex > uiscreen->data->games->count ||
+	gameindex < 0)
+	return;
+    uiscreen->data->gameindex = gameindex;
+    selectgame (uiscreen);
+
+    /* update the other fields on the screen */
+    for (c = 1; c < 3; ++c)
+	showoption (uiscreen, c, -(uiscreen->data->gameindex != 0));
 }
 
 /**
- * Adjust the level pack.
- * @param direction is the direction on the list.
+ * Move to another level pack for a new game.
+ * @param uiscreen  A pointer to the screen.
+ * @param packindex The level pack to move to.
  */
-static void adjustlevelpack (UIScreen *uiscreen, int direction)
+static void movetolevelpack (UIScreen *uiscreen, int packindex)
 {
     /* adjust the pack name itself */
-    uiscreen->data->packindex += direction;
-    if (uiscreen->data->packindex >= 16 ||
-	uiscreen->data->packindex < 0 ||
-	packrefs[uiscreen->data->packindex].filename[0] == 0) {
-	uiscreen->data->packindex -= direction;
+    if (packindex >= uiscreen->data->packs->count ||
+	packindex < 0)
 	return;
-    }
-    gamerefs[uiscreen->data->gameindex].packindex
-	= uiscreen->data->packindex;
+    uiscreen->data->packindex = packindex;
+    selectgame (uiscreen);
 
     /* adjust the saved config setting */
-    strcpy (config->levelpackfile,
-	    packrefs[uiscreen->data->packindex].filename);
+    strcpy (config->levelpackfile, uiscreen->data->current.packfile);
 }
 
 /*----------------------------------------------------------------------
@@ -197,103 +243,41 @@ static void adjustlevelpack (UIScreen *uiscreen, int direction)
  */
 
 /**
- * Initialise the list of levelpacks available.
+ * Open the game and level pack lists.
+ * @param uiscreen A pointer to the screen.
  */
-static void initialiselevelpackfiles (void)
+static void openlists (UIScreen *uiscreen)
 {
-    DIR *dir; /* directory handle */
-    struct dirent *direntry; /* a directory entry */
-    char *ext; /* pointer to filename extension */
-    int c = 0; /* levelpack counter */
-    LevelPack *levelpack; /* temporary levelpack variable */
-
-    /* Initialise the temporary levelpack variable */
-    if (! (levelpack = new_LevelPack ()))
-	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+    int packindex; /* the configured level pack in the list */
 
-    /* attempt to open the directory */
-    if (! (dir = opendir (".")))
-	fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
-
-    /* read each entry and see if it is a levelpack */
-    while (c < 16 && (direntry = readdir (dir))) {
-
-	/* skip past files that are not *.CAM files */
-	if (! (ext = strchr (direntry->d_name, '.')))
-	    continue;
-	if (strcmp (ext, ".lev") && strcmp (ext, ".LEV"))
-	    continue;
-
-	/* attempt to load the levelpack and add it to the list */
-	strcpy (levelpack->filename, direntry->d_name);
-	if (! levelpack->load (levelpack, 1))
-	    continue;
-	strcpy (packrefs[c].filename, levelpack->filename);
-	strcpy (packrefs[c].name, levelpack->name);
-	++c;
-    }
+    /* create the index and the lists */
+    if (! (uiscreen->data->dirindex = new_DirIndex ()))
+	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+    if (! (uiscreen->data->games = new_Catalogue
+	   (uiscreen->data->dirindex, DIRINDEX_GAME)))
+	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+    if (! (uiscreen->data->packs = new_Catalogue
+	   (uiscreen->data->dirindex, DIRINDEX_LEVELPACK)))
+	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
+    buildlists (uiscreen);
 
-    /* close the directory when done */
-    closedir (dir);
-    levelpack->destroy (levelpack);
+    /* start at a new game with the configured level pack */
+    packindex = uiscreen->data->packs->locate
+	(uiscreen->data->packs, config->levelpackfile);
+    uiscreen->data->packindex = packindex == -1 ? 0 : packindex;
+    uiscreen->data->gameindex = 0;
+    selectgame (uiscreen);
 }
 
 /**
- * Initialise the list if in-progress games.
+ * Close the game and level pack lists.
+ * @param uiscreen A pointer to the screen.
  */
-static void initialisegamefiles (void)
+static void closelists (UIScreen *uiscreen)
 {
-    DIR *dir; /* directory handle */
-    struct dirent *direntry; /* a directory entry */
-    char *ext, /* pointer to filename extension */
-	*ptr; /* pointer that strtol needs */
-    Game *game; /* temporary game buffer */
-    int g = 0; /* game counter */
-    time_t t; /* time in seconds since epoch */
-
-    /* the first entry is always "New Game" */
-    *gamerefs[g].filename = '\0';
-    strcpy (gamerefs[g].name, "New game");
-    strcpy (gamerefs[g].player, config->player);
-    gamerefs[g].packindex = 0;
-    ++g;
-
-    /* Initialise the temporary game variable */
-    if (! (game = new_Game ()))
-	fatalerror (FATAL_MEMORY, __FILE__, __LINE__);
-
-    /* attempt to open the directory */
-    if (! (dir = opendir (".")))
-	fatalerror (FATAL_INVALIDDATA, __FILE__, __LINE__);
-
-    /* read each entry and see if it is a levelpack */
-    while (g < 16 && (direntry = readdir (dir))) {
-
-	/* skip past files that are not *.CAM files */
-	if (! (ext = strchr (direntry->d_name, '.')))
-	    continue;
-	if (strcmp (ext, ".gam") && strcmp (ext, ".GAM"))
-	    continue;
-
-	/* add the game to the list */
-	strcpy (game->filename, direntry->d_name);
-	if (! game->load (game, 1))
-	    continue; /* invalid/not a game file */
-	strcpy (gamerefs[g].filename, direntry->d_name);
-	t = strtol (direntry->d_name, &ptr, 16);
-	strftime (gamerefs[g].name, 32, "%Y-%m-%d %H:%M:%S",
-		  localtime(&t));
-	strcpy (gamerefs[g].player, game->player);
-	gamerefs[g].packindex =
-	    identifylevelpack (game->levelpackfile);
-	if (gamerefs[g].packindex == -1)
-	    continue; /* invalid/deleted levelpack file */
-	++g;
-    }
-
-    /* close the directory when done */
-    game->destroy (game);
-    closedir (dir);
+    uiscreen->data->games->destroy (uiscreen->data->games);
+    uiscreen->data->packs->destroy (uiscreen->data->packs);
+    uiscreen->data->dirindex->destroy (uiscreen->data->dirindex);
 }
 
 /**
@@ -302,27 +286,23 @@ static void initialisegamefiles (void)
 static void getgameoptions (UIScreen *uiscreen)
 {
     int step, /* direction of change: left -1, right +1 */
-	key; /* keypress other than cursor controls and fire */
+	key, /* keypress other than cursor controls and fire */
+	position; /* position found by jumping to a letter */
+    Catalogue *games, /* the list of games */
+	*packs; /* the list of level packs */
 
     /* main game option loop */
+    games = uiscreen->data->games;
+    packs = uiscreen->data->packs;
     do {
 
 	/* highlight option and await control press */
-	display->showgameoption
-	    (gamerefs[uiscreen->data->gameindex].name,
-	     gamerefs[uiscreen->data->gameindex].player,
-	     packrefs[uiscreen->data->packindex].name,
-	     uiscreen->data->highlight,
-	     1);
+	showoption (uiscreen, uiscreen->data->highlight, 1);
 	display->update ();
 	controls->release (0);
 	controls->wait ();
-	display->showgameoption
-	    (gamerefs[uiscreen->data->gameindex].name,
-	     gamerefs[uiscreen->data->gameindex].player,
-	     packrefs[uiscreen->data->packindex].name,
-	     uiscreen->data->highlight,
-	     -(uiscreen->data->gameindex != 0));
+	showoption (uiscreen, uiscreen->data->highlight,
+		    -(uiscreen->data->gameindex != 0));
 
 	/* up/down controls */
 	if (controls->up () && uiscreen->data->highlight > 0)
@@ -336,24 +316,35 @@ static void getgameoptions (UIScreen *uiscreen)
 	else if ((step = controls->right () - controls->left ())) {
 	    switch (uiscreen->data->highlight) {
 	    case 0: /* game */
-		adjustgame (uiscreen, step);
+		movetogame (uiscreen, uiscreen->data->gameindex + step);
 		break;
 	    case 1: /* player */
-		renameplayer (uiscreen);
+		display->renameplayer (uiscreen->data->player);
+		selectgame (uiscreen);
 		break;
 	    case 2: /* level pack */
-		adjustlevelpack (uiscreen, step);
+		movetolevelpack (uiscreen, uiscreen->data->packindex + step);
 		break;
 	    }
 	}
 
-	/* printable characters */
-	else if (uiscreen->data->highlight == 1) {
-	    key = controls->key ();
-	    if (key > ' ' && key <= '~') {
-		sprintf (gamerefs[uiscreen->data->gameindex].player,
-			 "%c", toupper (key));
-		renameplayer (uiscreen);
+	/* printable characters jump along the lists or rename */
+	else if ((key = controls->key ()) > ' ' && key <= '~') {
+	    switch (uiscreen->data->highlight) {
+	    case 0: /* game */
+		if ((position = games->jump
+		     (games, uiscreen->data->gameindex - 1, key)) != -1)
+		    movetogame (uiscreen, position + 1);
+		break;
+	    case 1: /* player */
+		sprintf (uiscreen->data->player, "%c", toupper (key));
+		display->renameplayer (uiscreen->data->player);
+		selectgame (uiscreen);
+		break;
+	    case 2: /* level pack */
+		movetolevelpack (uiscreen, packs->jump
+				 (packs, uiscreen->data->packindex, key));
+		break;
 	    }
 	}
 
@@ -363,9 +354,9 @@ static void getgameoptions (UIScreen *uiscreen)
     display->update ();
 
     /* save "New Game" settings to configuration */
-    strcpy (config->player, gamerefs[0].player);
-    strcpy (config->levelpackfile,
-	    packrefs[gamerefs[0].packindex].filename);
+    strcpy (config->player, uiscreen->data->player);
+    if (uiscreen->data->gameindex == 0)
+	strcpy (config->levelpackfile, uiscreen->data->current.packfile);
 }
 
 /**
@@ -378,8 +369,7 @@ static UIState loadgame (UIScreen *uiscreen)
 
     /* load the game */
     game = uiscreen->data->game;
-    strcpy (game->filename,
-	    gamerefs[uiscreen->data->gameindex].filename);
+    strcpy (game->filename, uiscreen->data->current.filename);
     game->load (game, 0);
     strcpy (config->gamefile, game->filename);
     display->setgame (game);
@@ -397,15 +387,15 @@ static int preparegame (UIScreen *uiscreen)
     /* local variables */
     Game *game; /* pointer to the game */
     LevelPack *levelpack; /* the level pack */
+    Journal *journal; /* the game's journal */
 
     /* initialise the basic game data */
     game = uiscreen->data->game;
     game->clear (game);
     sprintf (game->filename, "%08lx.gam", time (NULL));
-    strcpy (game->player, gamerefs[uiscreen->data->gameindex].player);
+    strcpy (game->player, uiscreen->data->player);
     strcpy (game->score->player, game->player);
-    strcpy (game->levelpackfile,
-	    packrefs[uiscreen->data->packindex].filename);
+    strcpy (game->levelpackfile, uiscreen->data->current.packfile);
     game->state = STATE_SCORE;
     game->levelid = 0;
     game->turnno = 0;
@@ -425,6 +415,13 @@ static int preparegame (UIScreen *uiscreen)
 	levelpack->levels[game->levelid]
 	->clone (levelpack->levels[game->levelid]);
 
+    /* start a fresh journal for the game */
+    journal = new_Journal ();
+    journal->setgame (journal, game->filename);
+    strcpy (journal->levelpackfile, game->levelpackfile);
+    journal->create (journal);
+    journal->destroy (journal);
+
     /* save the game information in the configuration */
     strcpy (config->levelpackfile, game->levelpackfile);
     strcpy (config->gamefile, game->filename);
@@ -443,30 +440,57 @@ static int preparegame (UIScreen *uiscreen)
 static void deletegame (UIScreen *uiscreen)
 {
     int c; /* display line counter */
+    Journal *journal; /* the game's journal */
 
-    /* remove the game file */
-    unlink (gamerefs[uiscreen->data->gameindex].filename);
+    /* remove the game file and its journal */
+    unlink (uiscreen->data->current.filename);
+    journal = new_Journal ();
+    journal->setgame (journal, uiscreen->data->current.filename);
+    unlink (journal->filename);
+    journal->destroy (journal);
 
-    /* remove the game from the game refs */
-    for (c = uiscreen->data->gameindex; c < 15; ++c)
-	gamerefs[c] = gamerefs[c + 1];
-    *gamerefs[15].filename = '\0';
-    *gamerefs[15].name = '\0';
-    *gamerefs[15].player = '\0';
-    gamerefs[15].packindex = 0;
+    /* rebuild the lists without the game */
+    buildlists (uiscreen);
 
-    /* ensure we're not pointing at an empty game */
-    if (! *gamerefs[uiscreen->data->gameindex].filename &&
-	uiscreen->data->gameindex > 0)
-	--uiscreen->data->gameindex;
+    /* ensure we're not pointing past the end of the list */
+    if (uiscreen->data->gameindex > uiscreen->data->games->count)
+	uiscreen->data->gameindex = uiscreen->data->games->count;
+    selectgame (uiscreen);
 
     /* update the display */
     for (c = 0; c < 3; ++c)
-	display->showgameoption
-	    (gamerefs[uiscreen->data->gameindex].name,
-	     gamerefs[uiscreen->data->gameindex].player,
-	     packrefs[uiscreen->data->packindex].name,
-	     c, 0);
+	showoption (uiscreen, c, 0);
+    display->update ();
+}
+
+/**
+ * Switch the game list between last played and score order, staying
+ * on the same game.
+ * @param screen The user interface screen and its data.
+ */
+static void sortgames (UIScreen *uiscreen)
+{
+    int c, /* display line counter */
+	gameindex; /* the game's new place in the list */
+
+    /* rebuild the game list in the other order */
+    if (uiscreen->data->sort == CATALOGUE_LASTPLAYED)
+	uiscreen->data->sort = CATALOGUE_SCORE;
+    else
+	uiscreen->data->sort = CATALOGUE_LASTPLAYED;
+    buildlists (uiscreen);
+
+    /* find the game again */
+    if (uiscreen->data->gameindex) {
+	gameindex = uiscreen->data->games->locate
+	    (uiscreen->data->games, uiscreen->data->current.filename);
+	uiscreen->data->gameindex = gameindex + 1;
+    }
+    selectgame (uiscreen);
+
+    /* update the display */
+    for (c = 0; c < 3; ++c)
+	showoption (uiscreen, c, -(c && uiscreen->data->gameindex != 0));
     display->update ();
 }
 
@@ -480,25 +504,14 @@ static void deletegame (UIScreen *uiscreen)
  */
 static void init (UIScreen *uiscreen)
 {
-    int c; /* levelpack counter */
-
     /* save the current game and reset config to 'no game loaded' */
     if (*uiscreen->data->game->filename)
 	uiscreen->data->game->save (uiscreen->data->game);
     *config->gamefile = '\0';
 
     /* initialise the levelpack and game lists */
-    initialiselevelpackfiles ();
-    initialisegamefiles ();
-
-    /* initialise the list indexes */
-    for (c = 0; c < 16; ++c)
-	if (! strcmp (config->levelpackfile, packrefs[c].filename))
-	    uiscreen->data->packindex
-		= gamerefs[0].packindex
-		= c;
-    uiscreen->data->gameindex = 0;
-
+    strcpy (uiscreen->data->player, config->player);
+    openlists (uiscreen);
 }
 
 /**
@@ -508,23 +521,28 @@ static void init (UIScreen *uiscreen)
  */
 static UIState show (UIScreen *uiscreen)
 {
-    int option; /* option chosen from the menu */
+    int option, /* option chosen from the menu */
+	done = 0; /* 1 when a game is started or the user exits */
+    UIState state = STATE_QUIT; /* the state to return */
 
     /* initialise the display */
     display->shownewgame
-	(gamerefs[uiscreen->data->gameindex].name,
-	 gamerefs[uiscreen->data->gameindex].player,
-	 packrefs[uiscreen->data->packindex].name);
+	(uiscreen->data->current.name,
+	 uiscreen->data->current.player,
+	 uiscreen->data->current.packname);
     display->update ();
 
     /* main loop */
-    while (1) {
+    while (! done) {
 
 	/* allow navigation of the game options */
 	getgameoptions (uiscreen);
 
 	/* get a choice from the menu */
-	option = display->menu (4, newgamemenu, 1);
+	newgamemenu[3] = uiscreen->data->sort == CATALOGUE_LASTPLAYED
+	    ? "Sort by score"
+	    : "Sort by date";
+	option = display->menu (5, newgamemenu, 1);
 	switch (option) {
 
 	case 0: /* cancel menu */
@@ -532,9 +550,11 @@ static UIState show (UIScreen *uiscreen)
 
 	case 1: /* start game */
 	    if (uiscreen->data->gameindex)
-		return loadgame (uiscreen);
+		state = loadgame (uiscreen);
 	    else
-		return preparegame (uiscreen);
+		state = preparegame (uiscreen);
+	    done = 1;
+	    break;
 
 	case 2: /* delete game */
 	    if (uiscreen->data->gameindex &&
@@ -542,10 +562,19 @@ static UIState show (UIScreen *uiscreen)
 		deletegame (uiscreen);
 	    break;
 
-	case 3: /* exit game */
-	    return STATE_QUIT;
+	case 3: /* sort games */
+	    sortgames (uiscreen);
+	    break;
+
+	case 4: /* exit game */
+	    state = STATE_QUIT;
+	    done = 1;
 	}
     }
+
+    /* free the lists before moving on */
+    closelists (uiscreen);
+    return state;
 }
 
 /*----------------------------------------------------------------------
@@ -582,6 +611,7 @@ UIScreen *new_NewGameScreen (Game *game)
     uiscreen->data->gameindex = 0;
     uiscreen->data->packindex = 0;
     uiscreen->data->highlight = 0;
+    uiscreen->data->sort = CATALOGUE_LASTPLAYED;
 
     /* return the screen */
     return uiscreen;
@@ -371,8 +371,7 @@ static void resetlevel (UIScreen *uiscreen)
     Level *initial; /* initial state of the current level */
     game = uiscreen->data->game;
     initial = game->levelpack->levels[game->levelid];
-    game->level->destroy (game->level);
-    game->level = initial->clone (initial);
+    game->level->copy (game->level, initial);
     game->turnno = 0;
     game->state = STATE_DEPLOY;
 }